@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace blitz
+{
+    // IO线程的CPU绑定策略
+    enum class AffinityPolicy : std::uint8_t
+    {
+        NONE = 0,
+        CPU_LIST,           // 按给定CPU列表依次绑定
+        PHYSICAL_CORES,     // 每个线程独占一个物理核（超线程兄弟不复用）
+        NUMA_LOCAL,         // 线程在各NUMA节点间均分，绑定到节点内全部CPU
+    };
+
+    // 从/sys读取的CPU拓扑，仅包含当前进程允许使用的CPU
+    struct CpuTopology
+    {
+        std::vector<int> cpus;
+        std::vector<std::vector<int>> cores;    // 每个物理核的逻辑CPU
+        std::vector<std::vector<int>> nodes;    // 每个NUMA节点的逻辑CPU
+
+        static CpuTopology Detect();
+    };
+
+    // 计算每个线程的CPU集合，excluded中的CPU（如主线程独占的CPU）不参与分配；返回空集合表示不绑定
+    std::vector<std::vector<int>> PlanAffinity(AffinityPolicy policy, std::span<const int> cpuList, std::size_t threadNum,
+                                               std::span<const int> excluded, const CpuTopology& topo);
+
+    // 将调用线程绑定到cpus；此后该线程首次访问的内存按默认策略分配在本地节点
+    bool PinCurrentThread(std::span<const int> cpus);
+}   // namespace blitz
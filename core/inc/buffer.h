@@ -1,6 +1,8 @@
 #pragma once
+#include <atomic>
 #include <vector>
 #include <span>
+#include <string_view>
 #include <cstdint>
 
 #ifdef __linux__
@@ -15,25 +17,91 @@ namespace blitz
     {
         struct BufferChunk
         {
-            int refCnt;
+            std::atomic<int> refCnt;
             std::size_t readIdx;
             std::size_t writeIdx;
             std::vector<char> buf;
             BufferChunk* next;
+            // 非空时本节点为共享chunk的只读引用，数据位于ref->buf中，节点自身不持有存储
+            BufferChunk* ref;
+            // 非负时本节点为文件段，[readIdx, writeIdx)为待发送的文件偏移区间，数据不进入用户态
+            int fileFd;
 
             BufferChunk();
+            explicit BufferChunk(std::size_t capacity);
             ~BufferChunk() = default;
+            char* data();
+            const char* data() const;
+            bool isFile() const { return this->fileFd >= 0; }
             std::size_t readableSize() const;
             std::size_t writeableSize() const;
             std::size_t readFromChunk(std::span<char> data);
             std::size_t writeIntoChunk(std::span<const char> data);
             void moveInside();
         };
+        void ReleaseSharedChunk(BufferChunk* chunk);
     }   // namespace detail
 
+    // 不可变的共享数据：只拷贝一次，之后可按引用追加到任意多个ChainBuffer（可跨线程）
+    // 底层chunk由引用计数管理，最后一个引用它的写操作完成后释放
+    class SharedBuffer
+    {
+    public:
+        SharedBuffer() = delete;
+        explicit SharedBuffer(std::span<const char> data);
+        SharedBuffer(const SharedBuffer& rhs);
+        SharedBuffer& operator=(const SharedBuffer& rhs);
+        ~SharedBuffer();
+
+        std::size_t size() const;
+
+    private:
+        friend class ChainBuffer;
+        detail::BufferChunk* mChunk_;
+    };
+
+    // 写缓冲区中位于读指针处的文件段
+    struct FileRegion
+    {
+        int fd;
+        std::size_t offset;
+        std::size_t len;
+    };
+
     class ChainBuffer
     {
     public:
+        // 可读区域的只读视图：按chunk顺序逐段给出可读数据，不拷贝、不移动读指针
+        class ReadableSegments
+        {
+        public:
+            class Iterator
+            {
+            public:
+                Iterator(const detail::BufferChunk* chunk, const detail::BufferChunk* end) 
+                    : mChunk_{chunk}, mEnd_{end} {}
+
+                std::span<const char> operator*() const;
+                Iterator& operator++();
+                bool operator==(const Iterator& rhs) const { return this->mChunk_ == rhs.mChunk_; }
+                bool operator!=(const Iterator& rhs) const { return this->mChunk_ != rhs.mChunk_; }
+
+            private:
+                const detail::BufferChunk* mChunk_;
+                const detail::BufferChunk* mEnd_;
+            };
+
+            ReadableSegments(const detail::BufferChunk* first, const detail::BufferChunk* end)
+                : mFirst_{first}, mEnd_{end} {}
+
+            Iterator begin() const { return Iterator{this->mFirst_, this->mEnd_}; }
+            Iterator end() const { return Iterator{this->mEnd_, this->mEnd_}; }
+
+        private:
+            const detail::BufferChunk* mFirst_;
+            const detail::BufferChunk* mEnd_;
+        };
+
         ChainBuffer();
         ChainBuffer(const ChainBuffer&) = delete;
         ChainBuffer& operator=(const ChainBuffer&) = delete;
@@ -43,6 +111,34 @@ namespace blitz
 
         std::size_t readFromBuffer(std::span<char> data);
         std::size_t writeIntoBuffer(std::span<const char> data);
+        // 按引用追加共享数据，不拷贝
+        std::size_t appendShared(const SharedBuffer& data);
+        // 追加文件段：与内存数据按写入顺序交错发送，由EventQueue以splice直接从文件发往socket
+        // 文件描述符由调用方持有，须保证在该段发送完成前有效
+        std::size_t appendFile(int fd, std::size_t offset, std::size_t len);
+        // 读指针位于文件段时返回其剩余部分，否则返回false
+        bool frontFileRegion(FileRegion& region) const;
+
+        // 零拷贝读取：先通过视图/peek原地解析，再用consume移动读指针
+        // 视图、peek、find与readFromBuffer只覆盖首个文件段之前的内存数据；readableBytes含文件段
+        std::size_t readableBytes() const;
+        ReadableSegments readableSegments() const;
+        // 前n字节位于同一chunk内时返回其连续视图，否则返回空span
+        std::span<const char> peek(std::size_t n) const;
+        std::size_t consume(std::size_t n);
+
+        // 内存占用：仅统计本缓冲区持有的chunk；shrink归还数据之后多余的空chunk，直至不超过keepBytes
+        // 缓冲区为空且keepBytes为0时归还全部chunk；内核读写进行中不得调用
+        std::size_t capacityBytes() const;
+        void shrink(std::size_t keepBytes);
+        // 全局统计：所有线程已分配的chunk字节数（含池中缓存）与池中缓存的字节数
+        static std::size_t totalAllocatedBytes();
+        static std::size_t totalPooledBytes();
+
+        // 在可读区域中查找分隔符（可跨chunk），返回其相对读指针的偏移；未找到返回npos
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+        std::size_t find(char ch) const;
+        std::size_t find(std::string_view delim) const;
 
     public:
 #ifdef __linux__
@@ -52,7 +148,8 @@ namespace blitz
 #endif
         // 为分散-聚集IO准备；Linux为iovec，Win为WSABUF；具体转换到平台相关的结构，发生在EventQueue中
         std::span<const NativeIoVec> readableArea2Iovecs();
-        std::span<const NativeIoVec> writeableArea2Iovecs();
+        // maxBytes限定提交给内核的可写空间大小（不足时扩容），npos表示现有的全部可写空间
+        std::span<const NativeIoVec> writeableArea2Iovecs(std::size_t maxBytes = npos);
 
         // 为完成事件的出现而移动每个chunk的读写指针（即内核异步读写完成后移动读写指针）
         void moveReadableAreaIdx(std::size_t transferredBytes);
@@ -63,8 +160,10 @@ namespace blitz
         void destroyWriteableIovecs();
 
     private:
-        std::uint8_t mListSize_;
-        std::uint8_t mListCapacity_;
+        std::size_t mListCapacity_;
+        std::size_t mReadableBytes_;
+        std::size_t mFileChunkNum_;
+        // 链表不变式：[mChunkListHead_, mChunkListLastWithData_]依次存放有效数据，其后的chunk均为空
         detail::BufferChunk* mChunkListHead_;
         detail::BufferChunk* mChunkListLast_;
         detail::BufferChunk* mChunkListLastWithData_;
@@ -72,6 +171,11 @@ namespace blitz
         NativeIoVec* mReadableAreaIovecs_;
         NativeIoVec* mWriteableAreaIovecs_;
 
-        void expand(std::uint8_t chunkNum);
+        void expand(std::size_t chunkNum);
+        void appendNode(detail::BufferChunk* node);
+        const detail::BufferChunk* memoryAreaEnd() const;
+        void recycleHeadChunk();
+        void releaseNode(detail::BufferChunk* node);
+        void releaseChunks();
     };
 }   // namespace blitz
@@ -30,7 +30,10 @@ namespace blitz
         CLOSING,
         CLOSED,
         TIMEOUT,
-        SIGNAL
+        SIGNAL,
+        WAKEUP,
+        TIMER,
+        ENDPOINT    // 旁路端点（如指标端口）的监听与会话，完成结果原样交给上层
     };
 
     class Connection;
@@ -38,6 +41,7 @@ namespace blitz
     using SignalCallback = std::function<void()>;
     using IoEventCallback = std::function<void(Connection* conn)>;
     using ErrorCallback = std::function<void(Connection* conn, std::error_code ec)>;
+    using HighWaterCallback = std::function<void(Connection* conn, std::size_t bufferedBytes)>;
 
     class Event
     {
@@ -63,5 +67,8 @@ namespace blitz
         bool isClosed() const { return this->mCurEvent_ == EventType::CLOSED; }
         bool isTick() const { return this->mCurEvent_ == EventType::TIMEOUT; }
         bool isSignal() const { return this->mCurEvent_ == EventType::SIGNAL; }
+        bool isWakeup() const { return this->mCurEvent_ == EventType::WAKEUP; }
+        bool isTimer() const { return this->mCurEvent_ == EventType::TIMER; }
+        bool isEndpoint() const { return this->mCurEvent_ == EventType::ENDPOINT; }
     };
 }
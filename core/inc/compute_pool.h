@@ -0,0 +1,50 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace blitz
+{
+    struct ComputePoolStats
+    {
+        std::uint64_t submitted;
+        std::uint64_t completed;
+        std::size_t queueDepth;         // 当前排队等待执行的任务数
+        std::size_t peakQueueDepth;
+    };
+
+    // 执行阻塞型业务逻辑的计算线程池，与IO线程分离，避免慢回调阻塞整个IoService
+    class ComputePool
+    {
+    public:
+        using Job = std::function<void()>;
+
+        explicit ComputePool(std::size_t threadNum);
+        ComputePool(const ComputePool&) = delete;
+        ComputePool& operator=(const ComputePool&) = delete;
+        ~ComputePool();
+
+        // 线程池已停止时返回false，任务不会执行
+        bool submit(Job job);
+        ComputePoolStats stats() const noexcept;
+
+    private:
+        std::mutex mMtx_;
+        std::condition_variable mCv_;
+        std::deque<Job> mJobs_;
+        bool mStopped_;
+        std::atomic<std::uint64_t> mSubmitted_;
+        std::atomic<std::uint64_t> mCompleted_;
+        std::atomic<std::size_t> mQueueDepth_;
+        std::atomic<std::size_t> mPeakQueueDepth_;
+        std::vector<std::jthread> mThreads_;
+
+        void workerLoop();
+    };
+}   // namespace blitz
@@ -1,28 +1,224 @@
 #pragma once
+#include <atomic>
+#include <chrono>
 #include <coroutine>
 #include <span>
+#include <string_view>
+#include <utility>
 #include "buffer.h"
 #include "common.h"
+#include "connection_slab.h"
 #include "ec.h"
+#include "stage_latency.h"
+#include "task.h"
+#include "timing_wheel.h"
 
 namespace blitz
 {
+    namespace detail
+    {
+        // 按连接近期的读取量估计下一次提交给内核的接收区大小：
+        // 读满即翻倍以适应大流量，否则收敛到近期平均读取量的两倍，小报文连接保持最小接收区
+        class RecvSizeEstimator
+        {
+        public:
+            std::size_t target() const noexcept { return this->mTarget_; }
+            void update(std::size_t transferredBytes) noexcept;
+
+        private:
+            std::size_t mTarget_{InitTarget};
+            std::size_t mAverage_{InitTarget};     // 读取量的指数移动平均（权重1/8）
+
+            static constexpr std::size_t MinTarget = 1024;
+            static constexpr std::size_t InitTarget = 3 * 1024;
+            static constexpr std::size_t MaxTarget = 64 * 1024;
+        };
+
+        // 读方向状态：读缓冲区未分配时先等待可读，数据到达后再分配chunk并提交读
+        struct RecvState
+        {
+            bool polling = false;
+            bool pollDone = false;
+            bool shrinkRequested = false;   // 因空闲取消在途读，取消完成后归还读缓冲区
+            bool migrateRequested = false;  // 因迁移取消在途读，取消完成后交给目标IoService
+            RecvSizeEstimator estimator;
+        };
+    }   // namespace detail
+
+    // 连接的流量与处理耗时统计，用于挑选需要迁移的热点连接
+    struct TrafficStats
+    {
+        std::uint64_t readBytes;
+        std::uint64_t writeBytes;
+        std::uint64_t cpuNs;        // 读回调的累计执行耗时
+    };
+
+    // 接收统计：readBytes / readCount 即平均每次读取的字节数
+    struct RecvStats
+    {
+        std::uint64_t readCount;
+        std::uint64_t readBytes;
+        std::size_t recvWindow;     // 当前提交给内核的接收区大小
+    };
+
+#ifdef __linux__
+    namespace detail
+    {
+        enum class SpliceStage : std::uint8_t
+        {
+            NONE = 0,
+            TO_PIPE,
+            TO_SOCKET,
+        };
+
+        // splice须经由管道中转：文件 -> 管道 -> socket，管道按需创建
+        struct SplicePipe
+        {
+            int fds[2] = {-1, -1};
+            std::size_t pendingBytes = 0;   // 已进入管道、尚未发往socket的字节数
+            SpliceStage stage = SpliceStage::NONE;
+        };
+    }   // namespace detail
+#endif
+
+    class IoService;
+
     class Connection : public Event
     {
     public:
         Connection(SocketDescriptor socket);
-        ~Connection() = default;
+        ~Connection();
 
         void close();
+        // 可在任意线程调用（如超时回调）：交由所属IoService关闭，在途读写在内核中一并取消；
+        // 所属IoService的投递队列持续满时返回false，可稍后重试
+        bool requestClose();
 
         std::size_t read(std::span<char> buf, std::error_code& err);
         std::size_t write(std::span<const char> buf, std::error_code& err);
+        // 共享数据按引用写入，适用于同一数据广播给大量连接
+        std::size_t write(const SharedBuffer& buf, std::error_code& err);
+        // 将文件区间追加到写缓冲区，发送时不经用户态拷贝；fd由调用方持有，须在发送完成前保持有效
+        std::size_t writeFile(int fd, std::size_t offset, std::size_t len, std::error_code& err);
+        // 读取直到分隔符（含分隔符）；分隔符尚未到达或buf放不下时不消费任何数据
+        std::size_t readUntil(std::string_view delim, std::span<char> buf, std::error_code& err);
+
+        // 协程接口，仅可在ConnectionHandler及其co_await的Task中使用
+        // 读与写可分别有一个在途操作（如借助whenAll边读边写），同一方向同一时刻只允许一个
+        // 读缓冲区无数据时挂起直到内核读完成，再读出至多buf.size()字节
+        Task<std::size_t> asyncRead(std::span<char> buf, std::error_code& err);
+        // 挂起直到读缓冲区中出现分隔符，返回含分隔符的长度；数据留在读缓冲区，由调用方peek/consume
+        Task<std::size_t> asyncReadUntil(std::string_view delim, std::error_code& err);
+        // 写入写缓冲区并在后台写出；积压超过写高水位（未设置时为0）才挂起直到全部发出，据此实现流式发送的背压
+        Task<std::size_t> asyncWrite(std::span<const char> buf, std::error_code& err);
+        Task<std::size_t> asyncWrite(const SharedBuffer& buf, std::error_code& err);
+        // 挂起直到写缓冲区清空
+        Task<std::error_code> asyncFlush();
+
+        // 零拷贝读取接口，均作用于读缓冲区
+        std::size_t readableBytes() const { return this->mInputBuf_.readableBytes(); }
+        ChainBuffer::ReadableSegments readableSegments() const { return this->mInputBuf_.readableSegments(); }
+        std::span<const char> peek(std::size_t n) const { return this->mInputBuf_.peek(n); }
+        std::size_t consume(std::size_t n) { return this->mInputBuf_.consume(n); }
+        std::size_t find(std::string_view delim) const { return this->mInputBuf_.find(delim); }
 
         ChainBuffer& readBuffer() { return this->mInputBuf_; }
         ChainBuffer& writeBuffer() { return this->mOutputBuf_; }
+        // 读写缓冲区当前持有的内存字节数
+        std::size_t bufferBytes() const { return this->mInputBuf_.capacityBytes() + this->mOutputBuf_.capacityBytes(); }
+
+        detail::RecvState& recvState() { return this->mRecvState_; }
+        RecvStats recvStats() const { return {this->mReadCount_, this->mReadBytes_, this->mRecvState_.estimator.target()}; }
+        // 一次内核读完成后更新接收区估计与统计
+        void onRecvCompleted(std::size_t transferredBytes);
+        void onSendCompleted(std::size_t transferredBytes) { this->mWriteBytes_ += transferredBytes; }
+        void addCpuTime(std::chrono::nanoseconds t) { this->mCpuNs_ += t.count(); }
+        TrafficStats trafficStats() const { return {this->mReadBytes_, this->mWriteBytes_, this->mCpuNs_}; }
+        // 上次迁移检查时的统计快照，用于计算检查周期内的增量
+        TrafficStats& trafficSnapshot() { return this->mTrafficSnapshot_; }
+        // 迁移目标，仅在迁移请求发出至完成期间有效
+        IoService* migrateTarget() const { return this->mMigrateTarget_; }
+        void setMigrateTarget(IoService* target) { this->mMigrateTarget_ = target; }
+        std::chrono::steady_clock::time_point lastActiveTime() const { return this->mLastActiveTime_; }
+        void touch(std::chrono::steady_clock::time_point now) { this->mLastActiveTime_ = now; }
+        // 读/写完成时刷新空闲与对应方向的超时基准，仅两次赋值，定时器在到期时惰性重排
+        void onIoProgress(IoOpKind op, std::chrono::steady_clock::time_point now)
+        {
+            this->mLastActiveTime_ = now;
+            this->timeoutNode(ToTimeoutKind(op)).last = now;
+        }
+        // 提交读/写时记录超时起算时刻：读仅在新发起时记录，写的每次续写都说明上次写有进展
+        void onSubmitted(IoOpKind op, std::chrono::steady_clock::time_point now)
+        {
+            if (IoOpKind::WRITE == op || !this->isInflight(op))
+            {
+                this->timeoutNode(ToTimeoutKind(op)).last = now;
+            }
+        }
+#ifdef __linux__
+        detail::SplicePipe& splicePipe() { return this->mSplicePipe_; }
+#endif
+
+        // 所属IoService的事件队列，注册时设置
+        EventQueue* eventQueue() const { return this->mEventQueue_; }
+        void setEventQueue(EventQueue* q) { this->mEventQueue_ = q; }
+        // 按操作类型分别记录等待IO完成的协程、完成结果与是否在途，读写可同时进行
+        void setAwaiting(IoOpKind op, std::coroutine_handle<> handle) { this->mAwaiting_[OpIndex(op)] = handle; }
+        std::coroutine_handle<> takeAwaiting(IoOpKind op) { return std::exchange(this->mAwaiting_[OpIndex(op)], {}); }
+        void setIoError(IoOpKind op, std::error_code ec) { this->mIoError_[OpIndex(op)] = ec; }
+        std::error_code ioError(IoOpKind op) const { return this->mIoError_[OpIndex(op)]; }
+        void setInflight(IoOpKind op, bool on) { this->mInflight_[OpIndex(op)] = on; }
+        bool isInflight(IoOpKind op) const { return this->mInflight_[OpIndex(op)]; }
+        // 读回调交给计算线程执行期间为true，此间所属线程不触发超时、推迟关闭；两个标记只在所属线程读写
+        void setOffloaded(bool on) { this->mOffloaded_ = on; }
+        bool isOffloaded() const { return this->mOffloaded_; }
+        void setCloseDeferred(bool on) { this->mCloseDeferred_ = on; }
+        bool isCloseDeferred() const { return this->mCloseDeferred_; }
+        // 所在槽位的令牌，未放入槽位表时为0；requestClose会在其他线程读取
+        std::uint64_t slotToken() const { return this->mSlotToken_.load(std::memory_order_relaxed); }
+        std::size_t writeHighWater() const { return this->mWriteHighWater_; }
+        void setWriteHighWater(std::size_t bytes) { this->mWriteHighWater_ = bytes; }
+        void setSlotToken(std::uint64_t token) { this->mSlotToken_.store(token, std::memory_order_relaxed); }
+        // 所属IoService，放入槽位表后设置、迁出时清空；在所属线程中可经它使用定时器
+        IoService* owner() const { return this->mOwner_.load(std::memory_order_relaxed); }
+        void setOwner(IoService* owner) { this->mOwner_.store(owner, std::memory_order_release); }
+        // 各类超时的定时器节点，由Timer在时间轮中挂入或摘除
+        detail::ConnectionTimerNode& timeoutNode(TimeoutKind kind) { return this->mTimeoutNodes_[static_cast<std::size_t>(kind)]; }
+        // 最近一次到期的超时类型，供超时回调区分
+        TimeoutKind expiredTimeout() const { return this->mExpiredTimeout_; }
+        void setExpiredTimeout(TimeoutKind kind) { this->mExpiredTimeout_ = kind; }
+        // 各阶段计时的起点：accept与注册时在主线程写入，此后只在所属线程访问
+        detail::StageStamps& stageStamps() { return this->mStageStamps_; }
 
     private:
+        Task<std::error_code> drainIfAboveHighWater();
+        static std::size_t OpIndex(IoOpKind op) { return (IoOpKind::READ == op) ? 0 : 1; }
+        static TimeoutKind ToTimeoutKind(IoOpKind op) { return (IoOpKind::READ == op) ? TimeoutKind::READ : TimeoutKind::WRITE; }
+
         ChainBuffer mInputBuf_;
         ChainBuffer mOutputBuf_;
+        detail::RecvState mRecvState_;
+        std::uint64_t mReadCount_;
+        std::uint64_t mReadBytes_;
+        std::uint64_t mWriteBytes_;
+        std::uint64_t mCpuNs_;
+        TrafficStats mTrafficSnapshot_;
+        IoService* mMigrateTarget_;
+        std::chrono::steady_clock::time_point mLastActiveTime_;
+        EventQueue* mEventQueue_;
+        std::coroutine_handle<> mAwaiting_[2];
+        std::error_code mIoError_[2];
+        bool mInflight_[2];
+        bool mOffloaded_;
+        bool mCloseDeferred_;
+        std::atomic<std::uint64_t> mSlotToken_;
+        std::atomic<IoService*> mOwner_;
+        detail::ConnectionTimerNode mTimeoutNodes_[3];
+        TimeoutKind mExpiredTimeout_;
+        std::size_t mWriteHighWater_;
+        detail::StageStamps mStageStamps_;
+#ifdef __linux__
+        detail::SplicePipe mSplicePipe_;
+#endif
     };
 }   // namespace blitz
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace blitz
+{
+    class Connection;
+
+    // 连接上提交的内核操作类型，编码进io_uring的user_data
+    enum class IoOpKind : std::uint8_t
+    {
+        READ = 0,
+        WRITE,
+        CLOSE,
+    };
+
+    // 每个IoService一个的连接槽位表：连接按下标存放，槽位释放时代数加一
+    // 连接操作的user_data = 代数(高32位) | 槽位下标 | 操作类型 | 标记位(最低位为1)，
+    // 事件指针按8字节对齐、最低位为0，两者可直接区分；代数不符的完成事件即为过期事件
+    class ConnectionSlab
+    {
+    public:
+        constexpr static std::uint32_t InvalidSlot = static_cast<std::uint32_t>(-1);
+        constexpr static std::uint32_t MaxSlotNum = 1u << 28;
+
+        ConnectionSlab() : mFreeHead_{InvalidSlot}, mSize_{0} {}
+        ConnectionSlab(const ConnectionSlab&) = delete;
+        ConnectionSlab& operator=(const ConnectionSlab&) = delete;
+
+        // 占用一个槽位并把令牌写入连接，槽位耗尽时返回InvalidSlot
+        std::uint32_t insert(Connection* conn);
+        void remove(std::uint32_t slot);
+        Connection* at(std::uint32_t slot) const { return this->mSlots_[slot].conn; }
+        // 解析user_data，过期或非连接令牌返回nullptr
+        Connection* resolve(std::uint64_t token) const noexcept;
+
+        std::size_t size() const noexcept { return this->mSize_; }
+        std::size_t capacity() const noexcept { return this->mSlots_.size(); }
+
+        // 只遍历在用槽位，开销与当前连接数成正比而非历史峰值；fn中不得插入或移除连接
+        template <typename Fn>
+        void forEach(Fn&& fn) const
+        {
+            for (auto slot : this->mLive_)
+            {
+                fn(this->mSlots_[slot].conn);
+            }
+        }
+
+        static bool IsToken(std::uint64_t userData) noexcept { return userData & 1; }
+        static std::uint64_t MakeToken(std::uint32_t slot, std::uint32_t generation) noexcept
+        {
+            return (static_cast<std::uint64_t>(generation) << 32) | (static_cast<std::uint64_t>(slot) << 4) | 1;
+        }
+        static std::uint64_t WithOp(std::uint64_t token, IoOpKind op) noexcept
+        {
+            return (token & ~std::uint64_t{0xE}) | (static_cast<std::uint64_t>(op) << 1);
+        }
+        static std::uint32_t TokenSlot(std::uint64_t token) noexcept { return static_cast<std::uint32_t>(token >> 4) & (MaxSlotNum - 1); }
+        static std::uint32_t TokenGeneration(std::uint64_t token) noexcept { return static_cast<std::uint32_t>(token >> 32); }
+        static IoOpKind TokenOp(std::uint64_t token) noexcept { return static_cast<IoOpKind>((token >> 1) & 0x7); }
+
+    private:
+        struct Slot
+        {
+            Connection* conn;
+            std::uint32_t generation;
+            std::uint32_t nextFree;
+            std::uint32_t liveIdx;      // 在mLive_中的下标
+        };
+
+        std::vector<Slot> mSlots_;
+        std::vector<std::uint32_t> mLive_;      // 在用槽位的紧凑列表
+        std::uint32_t mFreeHead_;
+        std::size_t mSize_;
+    };
+}   // namespace blitz
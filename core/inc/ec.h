@@ -10,6 +10,8 @@ namespace blitz
         SubmitQueueFull,
         PeerClosed,
         InternalError,
+        DelimiterNotFound,
+        BufferTooSmall,
         // Other error
     };
 
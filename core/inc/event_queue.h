@@ -1,4 +1,7 @@
 #pragma once
+#include <chrono>
+#include <coroutine>
+#include <span>
 #include <thread>
 #include <vector>
 #ifdef __linux__
@@ -9,7 +12,10 @@
 #endif
 
 #include "common.h"
+#include "connection_slab.h"
 #include "ec.h"
+#include "metrics.h"
+#include "stage_latency.h"
 
 namespace blitz
 {
@@ -60,6 +66,34 @@ namespace blitz
         TickEvent();
     };
     
+    // 基于io_uring超时操作的一次性定时事件，到期后需重新提交
+    class TimeoutEvent : public Event
+    {
+    public:
+        TimeoutEvent() : Event{-1} { this->setEvent(EventType::TIMEOUT); }
+        struct __kernel_timespec& timespec() noexcept { return this->mTs_; }
+
+    private:
+        struct __kernel_timespec mTs_;
+    };
+    
+    // 基于eventfd的跨线程唤醒事件：其他线程调用notify()，使阻塞在io_uring上的线程返回
+    // 读操作完成后需重新提交
+    class WakeupEvent : public Event
+    {
+    public:
+        WakeupEvent();
+        WakeupEvent(const WakeupEvent&) = delete;
+        WakeupEvent& operator=(const WakeupEvent&) = delete;
+        ~WakeupEvent();
+
+        void notify() noexcept;
+        std::uint64_t& counter() noexcept { return this->mCounter_; }
+
+    private:
+        std::uint64_t mCounter_;
+    };
+
     class LinuxEventQueue
     {
     public:
@@ -72,17 +106,57 @@ namespace blitz
 
         Event* waitCompletionEvent(std::error_code& ec);
         std::error_code submitAccept(Acceptor& acceptor);
+        // 按连接当前事件（读/写）提交
         std::error_code submitIoEvent(Connection* conn);
+        std::error_code submitIoEvent(Connection* conn, IoOpKind op);
+        // 最近一次waitCompletionEvent返回的连接事件对应的操作类型
+        IoOpKind lastCompletedOp() const noexcept;
         std::error_code submitCloseConn(Connection* conn);
         std::error_code submitSysSignal(int sig);
         std::error_code submitTimerTick();
+        std::error_code submitTimeout(TimeoutEvent* ev, std::chrono::milliseconds timeoutMs);
+        // 绝对时间超时（CLOCK_MONOTONIC，与steady_clock一致），周期定时器据此不累积漂移
+        std::error_code submitTimeoutAt(TimeoutEvent* ev, std::chrono::steady_clock::time_point deadline);
+        // 取消已提交的超时操作，被取消的超时以-ECANCELED完成
+        std::error_code submitTimeoutRemove(TimeoutEvent* ev);
+        std::error_code submitCancel(Connection* conn);
+        std::error_code submitWakeup(WakeupEvent* ev);
+        // 设置后连接操作以槽位令牌作为user_data，完成时经槽位表解析并丢弃过期事件
+        void setConnectionSlab(ConnectionSlab* slab) noexcept;
+        // 所属IoService每轮事件循环缓存的时间，提交读写时据此记录超时起算时刻，避免逐次读取时钟；
+        // 每取得一个完成事件即在处理前刷新，处理中续发的读写不会沿用阻塞等待之前的时间
+        void setLoopClock(std::chrono::steady_clock::time_point* clock) noexcept;
+        // 设置后在读写提交与完成时按采样记录READ/WRITE/RESPONSE阶段延迟，nullptr表示不记录
+        void setStageHistograms(StageHistograms* stages) noexcept;
+        // 在调用线程上重建ring，使内核为SQ/CQ分配的内存位于该线程所在节点；须在提交任何请求前调用
+        std::error_code reinit();
+        // 旁路端点的收发与关闭：直接操作ev->socket()，完成事件原样返回，结果由lastResult()取得
+        // timeout大于0时挂接超时，到期未完成的收发被取消，以-ECANCELED完成
+        std::error_code submitRecv(Event* ev, std::span<char> buf, std::chrono::milliseconds timeout = std::chrono::milliseconds{0});
+        std::error_code submitSend(Event* ev, std::span<const char> buf, std::chrono::milliseconds timeout = std::chrono::milliseconds{0});
+        std::error_code submitClose(Event* ev);
+        // 最近一次waitCompletionEvent返回的完成事件的原始结果
+        std::int32_t lastResult() const noexcept;
+        // 本队列的计数，可在其他线程读取
+        const MetricsBlock& metrics() const noexcept;
 
     private:
         struct io_uring mRing_;
         struct io_uring_cqe* mCompletionQueue_;
+        ConnectionSlab* mSlab_;
+        IoOpKind mLastOp_;
+        std::chrono::steady_clock::time_point* mLoopClock_;
+        std::int32_t mLastRes_;
+        MetricsBlock mMetrics_;
+        StageHistograms* mStages_;
 
+        std::error_code onQueueFull() noexcept;
+        void recordWriteDrained(Connection* conn);
         Event* handleAccept(Event* event);
-        Event* handleIo(Event* event);
+        Event* handleIo(Connection* conn, IoOpKind op, std::error_code& ec);
+        Event* handleCanceledRead(Connection* conn, std::error_code& ec);
+        Event* handleIoError(Connection* conn, IoOpKind op);
+        Event* continueWrite(Connection* conn, std::error_code& ec);
 
         struct iovec* chainBuffer2ReadIovecs(ChainBuffer& buf, std::size_t& len);
         struct iovec* chainBuffer2WriteIovecs(ChainBuffer& buf, std::size_t& len);
@@ -104,10 +178,39 @@ namespace blitz
 
         Event* waitCompletionEvent(std::error_code& ec);
         std::error_code submitAccept(Acceptor& acceptor);
+        // 按连接当前事件（读/写）提交
         std::error_code submitIoEvent(Connection* conn);
+        std::error_code submitIoEvent(Connection* conn, IoOpKind op);
+        // 最近一次waitCompletionEvent返回的连接事件对应的操作类型
+        IoOpKind lastCompletedOp() const noexcept;
         std::error_code submitCloseConn(Connection* conn);
         std::error_code submitSysSignal(int sig);
         std::error_code submitTimerTick();
+        std::error_code submitTimeout(TimeoutEvent* ev, std::chrono::milliseconds timeoutMs);
+        // 绝对时间超时（CLOCK_MONOTONIC，与steady_clock一致），周期定时器据此不累积漂移
+        std::error_code submitTimeoutAt(TimeoutEvent* ev, std::chrono::steady_clock::time_point deadline);
+        // 取消已提交的超时操作，被取消的超时以-ECANCELED完成
+        std::error_code submitTimeoutRemove(TimeoutEvent* ev);
+        std::error_code submitCancel(Connection* conn);
+        std::error_code submitWakeup(WakeupEvent* ev);
+        // 设置后连接操作以槽位令牌作为user_data，完成时经槽位表解析并丢弃过期事件
+        void setConnectionSlab(ConnectionSlab* slab) noexcept;
+        // 所属IoService每轮事件循环缓存的时间，提交读写时据此记录超时起算时刻，避免逐次读取时钟；
+        // 每取得一个完成事件即在处理前刷新，处理中续发的读写不会沿用阻塞等待之前的时间
+        void setLoopClock(std::chrono::steady_clock::time_point* clock) noexcept;
+        // 设置后在读写提交与完成时按采样记录READ/WRITE/RESPONSE阶段延迟，nullptr表示不记录
+        void setStageHistograms(StageHistograms* stages) noexcept;
+        // 在调用线程上重建ring，使内核为SQ/CQ分配的内存位于该线程所在节点；须在提交任何请求前调用
+        std::error_code reinit();
+        // 旁路端点的收发与关闭：直接操作ev->socket()，完成事件原样返回，结果由lastResult()取得
+        // timeout大于0时挂接超时，到期未完成的收发被取消，以-ECANCELED完成
+        std::error_code submitRecv(Event* ev, std::span<char> buf, std::chrono::milliseconds timeout = std::chrono::milliseconds{0});
+        std::error_code submitSend(Event* ev, std::span<const char> buf, std::chrono::milliseconds timeout = std::chrono::milliseconds{0});
+        std::error_code submitClose(Event* ev);
+        // 最近一次waitCompletionEvent返回的完成事件的原始结果
+        std::int32_t lastResult() const noexcept;
+        // 本队列的计数，可在其他线程读取
+        const MetricsBlock& metrics() const noexcept;
 
     private:
     };
@@ -129,9 +232,25 @@ namespace blitz
         Event* waitCompletionEvent(std::error_code& ec) { return impl_.waitCompletionEvent(ec); }
         std::error_code submitAccept(Acceptor& acceptor) { return impl_.submitAccept(acceptor); }
         std::error_code submitIoEvent(Connection* conn) { return impl_.submitIoEvent(conn); }
+        std::error_code submitIoEvent(Connection* conn, IoOpKind op) { return impl_.submitIoEvent(conn, op); }
+        IoOpKind lastCompletedOp() const noexcept { return impl_.lastCompletedOp(); }
         std::error_code submitCloseConn(Connection* conn) { return impl_.submitCloseConn(conn); }
         std::error_code submitSysSignal(int sig) { return impl_.submitSysSignal(sig); }
         std::error_code submitTimerTick() { return impl_.submitTimerTick(); }
+        std::error_code submitTimeout(TimeoutEvent* ev, std::chrono::milliseconds timeoutMs) { return impl_.submitTimeout(ev, timeoutMs); }
+        std::error_code submitTimeoutAt(TimeoutEvent* ev, std::chrono::steady_clock::time_point deadline) { return impl_.submitTimeoutAt(ev, deadline); }
+        std::error_code submitTimeoutRemove(TimeoutEvent* ev) { return impl_.submitTimeoutRemove(ev); }
+        std::error_code submitCancel(Connection* conn) { return impl_.submitCancel(conn); }
+        std::error_code submitWakeup(WakeupEvent* ev) { return impl_.submitWakeup(ev); }
+        void setConnectionSlab(ConnectionSlab* slab) noexcept { impl_.setConnectionSlab(slab); }
+        std::error_code reinit() { return impl_.reinit(); }
+        void setLoopClock(std::chrono::steady_clock::time_point* clock) noexcept { impl_.setLoopClock(clock); }
+        void setStageHistograms(StageHistograms* stages) noexcept { impl_.setStageHistograms(stages); }
+        std::error_code submitRecv(Event* ev, std::span<char> buf, std::chrono::milliseconds timeout = std::chrono::milliseconds{0}) { return impl_.submitRecv(ev, buf, timeout); }
+        std::error_code submitSend(Event* ev, std::span<const char> buf, std::chrono::milliseconds timeout = std::chrono::milliseconds{0}) { return impl_.submitSend(ev, buf, timeout); }
+        std::error_code submitClose(Event* ev) { return impl_.submitClose(ev); }
+        std::int32_t lastResult() const noexcept { return impl_.lastResult(); }
+        const MetricsBlock& metrics() const noexcept { return impl_.metrics(); }
     
     private:
         EventQueueImpl impl_;
@@ -0,0 +1,75 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace blitz
+{
+    // 协程帧分配统计，计数可在其他线程读取
+    struct FrameArenaStats
+    {
+        std::uint64_t allocCount;       // 帧分配总次数
+        std::uint64_t poolHits;         // 命中空闲链表的次数
+        std::uint64_t oversizeCount;    // 超出最大分桶、直接走全局operator new的次数
+        std::uint64_t liveFrames;       // 当前未释放的帧数
+        std::size_t maxFrameSize;       // 出现过的最大帧大小
+    };
+
+    // 按大小分桶的协程帧内存池，每个IoService一个，只在其所属线程上分配与释放
+    // 每个帧前有一个头部记录所属内存池与分桶，释放时据此归还
+    class FrameArena
+    {
+    public:
+        constexpr static std::size_t BucketGranularity = 64;
+        constexpr static std::size_t BucketNum = 64;           // 最大分桶 64 * 64 = 4KB
+        constexpr static std::size_t MaxPooledPerBucket = 256;
+
+        FrameArena();
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+        ~FrameArena();
+
+        // arena为空时直接使用全局operator new，仍附带头部以便统一释放
+        static void* Allocate(FrameArena* arena, std::size_t size);
+        static void Deallocate(void* frame) noexcept;
+
+        FrameArenaStats stats() const noexcept;
+        // 第i个分桶（帧大小不超过(i+1)*64字节）的分配次数
+        std::uint64_t bucketAllocs(std::size_t i) const noexcept { return this->mBucketAllocs_[i].load(std::memory_order_relaxed); }
+
+    private:
+        struct FreeNode
+        {
+            FreeNode* next;
+        };
+
+        std::array<FreeNode*, BucketNum> mFreeLists_;
+        std::array<std::size_t, BucketNum> mFreeSizes_;
+        std::array<std::atomic<std::uint64_t>, BucketNum> mBucketAllocs_;
+        std::atomic<std::uint64_t> mAllocCount_;
+        std::atomic<std::uint64_t> mPoolHits_;
+        std::atomic<std::uint64_t> mOversizeCount_;
+        std::atomic<std::uint64_t> mLiveFrames_;
+        std::atomic<std::size_t> mMaxFrameSize_;
+
+        void* allocate(std::size_t size);
+        void deallocate(void* block, std::uint32_t bucket) noexcept;
+    };
+
+    namespace detail
+    {
+        // 当前线程正在驱动的IoService的帧内存池，供不直接持有IoService的协程类型使用
+        FrameArena*& CurrentFrameArena() noexcept;
+
+        class FrameArenaGuard
+        {
+        public:
+            explicit FrameArenaGuard(FrameArena* arena) : mPrev_{CurrentFrameArena()} { CurrentFrameArena() = arena; }
+            ~FrameArenaGuard() { CurrentFrameArena() = this->mPrev_; }
+
+        private:
+            FrameArena* mPrev_;
+        };
+    }   // namespace detail
+}   // namespace blitz
@@ -0,0 +1,140 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace blitz
+{
+    namespace detail
+    {
+        // 按2的幂分桶：第i桶统计[2^i, 2^(i+1))，0计入第0桶
+        struct Log2Buckets
+        {
+            constexpr static std::size_t BucketNum = 64;
+
+            static std::size_t BucketIndex(std::uint64_t value) noexcept
+            {
+                return (0 == value) ? 0 : std::bit_width(value) - 1;
+            }
+
+            static std::uint64_t BucketUpperBound(std::size_t index) noexcept
+            {
+                return (index + 1 < BucketNum) ? (std::uint64_t{2} << index) - 1 : ~std::uint64_t{0};
+            }
+        };
+
+        // 对数-线性分桶（HdrHistogram式）：每个2的幂区间再线性分为SubBucketNum个子桶，相对误差不超过1/SubBucketNum
+        // 小于SubBucketNum的值各占一桶，不小于2^MaxExponent（约18分钟）的值计入最后的溢出桶
+        struct LogLinearBuckets
+        {
+            constexpr static std::size_t SubBucketBits = 4;
+            constexpr static std::size_t SubBucketNum = std::size_t{1} << SubBucketBits;
+            constexpr static std::size_t MaxExponent = 40;
+            constexpr static std::size_t BucketNum = (MaxExponent - SubBucketBits + 1) * SubBucketNum + 1;
+
+            static std::size_t BucketIndex(std::uint64_t value) noexcept
+            {
+                if (value < SubBucketNum)   return static_cast<std::size_t>(value);
+                std::size_t exponent = std::bit_width(value) - 1;
+                if (exponent >= MaxExponent)    return BucketNum - 1;
+                std::size_t shift = exponent - SubBucketBits;
+                return (shift + 1) * SubBucketNum + static_cast<std::size_t>((value >> shift) - SubBucketNum);
+            }
+
+            // 桶内最大值
+            static std::uint64_t BucketUpperBound(std::size_t index) noexcept
+            {
+                if (index < SubBucketNum)   return index;
+                if (index == BucketNum - 1) return ~std::uint64_t{0};
+                std::size_t shift = index / SubBucketNum - 1;
+                std::uint64_t sub = index % SubBucketNum + SubBucketNum;
+                return ((sub + 1) << shift) - 1;
+            }
+        };
+    }   // namespace detail
+
+    // 延迟直方图（纳秒），分桶方式由Buckets给出
+    // 仅所属线程记录与reset，其他线程可随时读取快照：快照逐桶复制BucketNum个计数，各桶之间不保证同一时刻
+    template<typename Buckets>
+    class BasicHistogram
+    {
+    public:
+        constexpr static std::size_t BucketNum = Buckets::BucketNum;
+
+        static std::size_t BucketIndex(std::uint64_t value) noexcept { return Buckets::BucketIndex(value); }
+        static std::uint64_t BucketUpperBound(std::size_t index) noexcept { return Buckets::BucketUpperBound(index); }
+
+        struct Snapshot
+        {
+            std::array<std::uint64_t, BucketNum> counts{};
+
+            std::uint64_t count() const noexcept
+            {
+                std::uint64_t total = 0;
+                for (auto c : this->counts)
+                {
+                    total += c;
+                }
+                return total;
+            }
+
+            // 返回第p（0~1）分位所在桶的上界，无样本时为0
+            std::uint64_t percentile(double p) const noexcept
+            {
+                std::uint64_t total = this->count();
+                if (0 == total) return 0;
+                auto rank = static_cast<std::uint64_t>(p * static_cast<double>(total - 1)) + 1;
+                std::uint64_t seen = 0;
+                for (std::size_t i = 0; i < BucketNum; ++i)
+                {
+                    seen += this->counts[i];
+                    if (seen >= rank)   return BucketUpperBound(i);
+                }
+                return ~std::uint64_t{0};
+            }
+
+            Snapshot& operator+=(const Snapshot& rhs) noexcept
+            {
+                for (std::size_t i = 0; i < BucketNum; ++i)
+                {
+                    this->counts[i] += rhs.counts[i];
+                }
+                return *this;
+            }
+        };
+
+        void record(std::uint64_t ns) noexcept
+        {
+            auto& bucket = this->mCounts_[BucketIndex(ns)];
+            bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        Snapshot snapshot() const noexcept
+        {
+            Snapshot s;
+            for (std::size_t i = 0; i < BucketNum; ++i)
+            {
+                s.counts[i] = this->mCounts_[i].load(std::memory_order_relaxed);
+            }
+            return s;
+        }
+
+        void reset() noexcept
+        {
+            for (auto& bucket : this->mCounts_)
+            {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        std::array<std::atomic<std::uint64_t>, BucketNum> mCounts_{};
+    };
+
+    // 64桶，精度为2倍，快照512字节：用于投递延迟等只需量级的统计
+    using LatencyHistogram = BasicHistogram<detail::Log2Buckets>;
+    // 593桶，相对误差不超过1/16，快照约4.6KB：用于需要较准分位数的阶段延迟
+    using LogLinearHistogram = BasicHistogram<detail::LogLinearBuckets>;
+}   // namespace blitz
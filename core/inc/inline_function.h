@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace blitz
+{
+    namespace detail
+    {
+        template<typename Sig, std::size_t Capacity>
+        class InlineFunction;
+
+        // 只做内联存储的可调用对象包装：捕获超出Capacity时编译失败而非退化为堆分配，仅可移动
+        template<typename R, typename... Args, std::size_t Capacity>
+        class InlineFunction<R(Args...), Capacity>
+        {
+        public:
+            InlineFunction() noexcept = default;
+
+            template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InlineFunction>>>
+            InlineFunction(F&& f)
+            {
+                using Fn = std::decay_t<F>;
+                static_assert(sizeof(Fn) <= Capacity, "callable too large for inline storage");
+                static_assert(alignof(Fn) <= alignof(std::max_align_t), "callable over-aligned");
+                static_assert(std::is_nothrow_move_constructible_v<Fn>, "callable must be nothrow movable");
+                ::new (static_cast<void*>(this->mStorage_)) Fn(std::forward<F>(f));
+                this->mOps_ = &OpsFor<Fn>;
+            }
+
+            InlineFunction(InlineFunction&& rhs) noexcept { this->moveFrom(rhs); }
+            InlineFunction& operator=(InlineFunction&& rhs) noexcept
+            {
+                if (this != &rhs)
+                {
+                    this->reset();
+                    this->moveFrom(rhs);
+                }
+                return *this;
+            }
+            InlineFunction(const InlineFunction&) = delete;
+            InlineFunction& operator=(const InlineFunction&) = delete;
+            ~InlineFunction() { this->reset(); }
+
+            explicit operator bool() const noexcept { return nullptr != this->mOps_; }
+            R operator()(Args... args) { return this->mOps_->invoke(this->mStorage_, std::forward<Args>(args)...); }
+
+            void reset() noexcept
+            {
+                if (this->mOps_)
+                {
+                    this->mOps_->destroy(this->mStorage_);
+                    this->mOps_ = nullptr;
+                }
+            }
+
+        private:
+            struct Ops
+            {
+                R (*invoke)(void* storage, Args&&... args);
+                void (*move)(void* dst, void* src) noexcept;
+                void (*destroy)(void* storage) noexcept;
+            };
+
+            template<typename Fn>
+            constexpr static Ops OpsFor
+            {
+                [](void* storage, Args&&... args)->R { return (*static_cast<Fn*>(storage))(std::forward<Args>(args)...); },
+                [](void* dst, void* src) noexcept { ::new (dst) Fn(std::move(*static_cast<Fn*>(src))); static_cast<Fn*>(src)->~Fn(); },
+                [](void* storage) noexcept { static_cast<Fn*>(storage)->~Fn(); },
+            };
+
+            alignas(std::max_align_t) unsigned char mStorage_[Capacity];
+            const Ops* mOps_ = nullptr;
+
+            void moveFrom(InlineFunction& rhs) noexcept
+            {
+                if (rhs.mOps_)
+                {
+                    rhs.mOps_->move(this->mStorage_, rhs.mStorage_);
+                    this->mOps_ = std::exchange(rhs.mOps_, nullptr);
+                }
+            }
+        };
+    }   // namespace detail
+}   // namespace blitz
@@ -1,12 +1,27 @@
 #pragma once
+#include <chrono>
 #include <coroutine>
+#include <atomic>
 #include <functional>
-#include <unordered_map>
+#include <vector>
+#include "compute_pool.h"
+#include "connection_slab.h"
 #include "ec.h"
 #include "event_queue.h"
+#include "frame_arena.h"
+#include "histogram.h"
+#include "metrics.h"
+#include "mpsc_queue.h"
+#include "placement.h"
+#include "stage_latency.h"
+#include "task.h"
+#include "timer.h"
+#include "timer_slab.h"
 
 namespace blitz
 {
+    class IoService;
+
     // 将任务（Channel）提交到SQE（提交队列）后挂起协程
     // CQE（完成队列）有完成事件返回时恢复协程
     class AsyncTask
@@ -19,6 +34,11 @@ namespace blitz
             void return_void() noexcept {} 
             auto initial_suspend() noexcept;
             auto final_suspend() noexcept;
+
+            // 协程帧从所属IoService的内存池分配
+            static void* operator new(std::size_t size, IoService& service, Connection* conn);
+            static void* operator new(std::size_t size);
+            static void operator delete(void* frame) noexcept;
         };
 
         AsyncTask() = default;
@@ -39,44 +59,207 @@ namespace blitz
     {
     public:
         bool await_ready() const noexcept;
-        void await_suspend(std::coroutine_handle<> handle) noexcept;
+        bool await_suspend(std::coroutine_handle<> handle) noexcept;
         std::error_code await_resume() const noexcept;
 
+        // 操作类型取自连接当前事件（读/写）
         IoTaskAwaiter(EventQueue* q, Connection* conn);
+        IoTaskAwaiter(EventQueue* q, Connection* conn, IoOpKind op);
 
     private:
         std::error_code ec;
         Connection* mConn_;
+        IoOpKind mOp_;
         EventQueue* mEventQueue_;
     };
 
-    class Timer;
+    namespace detail
+    {
+        // 由其他线程投递回IoService、待在所属线程上恢复的协程
+        struct PostedResume : MpscNode
+        {
+            std::coroutine_handle<> handle;
+        };
+    }   // namespace detail
+
+    // 将业务逻辑交给计算线程池执行后挂起，执行完毕后经所属IoService的无锁队列投递回IO线程恢复
+    // 执行期间被要求关闭的连接（超时、requestClose等）在恢复后才关闭，await_resume返回true时由调用方关闭
+    class OffloadAwaiter
+    {
+    public:
+        OffloadAwaiter(IoService* service, Connection* conn, ComputePool::Job job);
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle) noexcept;
+        bool await_resume() noexcept;
+
+    private:
+        IoService* mService_;
+        Connection* mConn_;
+        ComputePool::Job mJob_;
+        detail::PostedResume mResume_;
+    };
+
+    // 投递到IoService线程执行的任务，捕获内联存放，超出容量时编译失败
+    using PostCallback = detail::InlineFunction<void(), 64>;
 
     class IoService
     {
     public:
-        IoService() = default;
+        constexpr static std::size_t PostQueueCapacity = 1024;
+
+        IoService();
         IoService(const IoService&) = delete;
         IoService& operator=(const IoService&) = delete;
-        IoService(IoService&&) = default;
-        IoService& operator=(IoService&&) = default;
+        IoService(IoService&&) = delete;
+        IoService& operator=(IoService&&) = delete;
         ~IoService();
 
         void setReadCallback(IoEventCallback cb) noexcept { this->mReadCb_ = cb; }
         void setWriteCallback(IoEventCallback cb) noexcept { this->mWriteCb_ = cb; }
         void setErrorCallback(ErrorCallback cb) noexcept { this->mErrCb_ = cb; }
+        // 设置后以协程方式处理连接，替代读写回调；处理协程结束后关闭连接
+        void setConnectionHandler(ConnectionHandler handler) noexcept { this->mHandler_ = handler; }
+        // 长连接模式：读->回调->写循环执行，直到回调调用close()或对端关闭
+        void setKeepAlive(bool on) noexcept { this->mKeepAlive_ = on; }
+        // 写缓冲区积压超过bytes时：回调方式下在提交写出前调用cb，协程方式下asyncWrite挂起直到写完
+        void setWriteHighWater(std::size_t bytes, HighWaterCallback cb) noexcept { this->mWriteHighWater_ = bytes; this->mHighWaterCb_ = cb; }
+        // 缓冲区回收策略：连接空闲超过idleTime后归还其全部空闲chunk；缓冲区超过highWaterBytes时在读写完成后裁剪
+        void setBufferShrinkPolicy(std::chrono::milliseconds idleTime, std::size_t highWaterBytes) noexcept;
 
-        void runOnce(Timer& t);
+        void runOnce();
+        // 连接超时：接管连接时开始计时，到期后在本线程调用cb；定时由本IoService的ring驱动，resolution为检查间隔
+        void setTimeoutCallback(TimeoutCallback cb, std::chrono::milliseconds timeoutMs) noexcept;
+        void setTimerResolution(std::chrono::milliseconds resolution) noexcept { this->mTimerResolution_ = resolution; }
+        // 通用定时器：仅可在本IoService线程中调用（如处理协程或回调中经conn->owner()取得），回调也在本线程执行。
+        // 每个定时器对应一个io_uring超时操作，槽位与回调均复用，稳态下不分配内存；提交失败时返回无效句柄
+        TimerId runAfter(std::chrono::milliseconds delay, TimerCallback cb);
+        // 按绝对时间逐周期重排，不累积漂移；落后超过一个周期时不补发
+        TimerId runEvery(std::chrono::milliseconds interval, TimerCallback cb);
+        // 可在回调中取消自身；句柄已失效（一次性定时器已执行、已取消）时返回false
+        bool cancel(TimerId id);
+        // 读/写超时，到期同样调用超时回调；0表示不检查
+        void setIoTimeouts(std::chrono::milliseconds readMs, std::chrono::milliseconds writeMs) noexcept { this->mTimer_.setIoTimeouts(readMs, writeMs); }
+        // 可在任意线程调用：连接经投递队列交给所属线程接管；队列持续满时关闭该连接
         void registConnection(Connection* conn);
+        // 可在任意线程调用：接收从其他IoService迁入的连接
+        void acceptMigrated(Connection* conn);
         void wakeupFromWait();
+        // 可在任意线程调用：由所属线程关闭令牌仍有效的连接；投递队列持续满时返回false，请求未送达
+        bool requestClose(Connection* conn, std::uint64_t token);
+        // 在运行事件循环的线程上（绑核之后）重建io_uring，须在首次runOnce前调用
+        std::error_code rebindToCurrentThread() { return this->mEventQueue_.reinit(); }
+
+        // 设置后读回调在计算线程池中执行，不阻塞本IO线程
+        void setComputePool(ComputePool* pool) noexcept { this->mComputePool_ = pool; }
+        ComputePool* computePool() const noexcept { return this->mComputePool_; }
+        // 可在任意线程调用：将协程投递回本IoService，由所属线程恢复
+        void post(detail::PostedResume* node);
+        // 可在任意线程调用：在本IoService线程中执行fn；有界队列已满时返回false，不阻塞也不分配内存。
+        // 每轮事件循环成批执行，连续投递在目标线程取走之前只触发一次唤醒
+        bool post(PostCallback fn);
+        // 已在本IoService的事件循环中时立即执行，否则同post
+        bool dispatch(PostCallback fn);
+        // 任务从投递到开始执行的延迟分布，可在其他线程读取
+        LatencyHistogram::Snapshot postLatency() const noexcept { return this->mPostLatency_.snapshot(); }
+        std::size_t postedQueueDepth() const noexcept { return this->mPostedDepth_.load(std::memory_order_relaxed); }
+        std::size_t peakPostedQueueDepth() const noexcept { return this->mPeakPostedDepth_.load(std::memory_order_relaxed); }
+
+        // 迁移：每interval找出本IoService上处于请求间空闲状态的最热连接，连同其周期内耗时交给pickTarget，
+        // 由其决定迁往哪个IoService（返回nullptr不迁移）；每次最多迁出一个
+        // 仅长连接回调模式的连接可迁移，协程处理函数的状态无法跨线程转移
+        using MigrationTargetFn = std::function<IoService*(IoService& self, std::uint64_t connCpuNs)>;
+        void setMigrationPolicy(std::chrono::milliseconds interval, MigrationTargetFn pickTarget) noexcept;
+        // 最近一个迁移检查周期内的处理耗时，可在其他线程读取
+        std::uint64_t recentBusyNs() const noexcept { return this->mRecentBusyNs_.load(std::memory_order_relaxed); }
+        std::uint64_t migratedOut() const noexcept { return this->mMigratedOut_.load(std::memory_order_relaxed); }
+        std::uint64_t migratedIn() const noexcept { return this->mMigratedIn_.load(std::memory_order_relaxed); }
+
+        // 负载计数，可在其他线程读取
+        IoServiceLoad load() const noexcept
+        {
+            return {this->mActiveConns_.load(std::memory_order_relaxed), this->mBusyNs_.load(std::memory_order_relaxed)};
+        }
+
+        // 本IoService及其事件队列的计数，按需聚合，可在其他线程读取
+        MetricsSnapshot metrics() const noexcept;
+        // 请求各阶段延迟：每every个事件采样一次，0表示关闭（默认）；须在事件循环启动前设置
+        void setStageSampling(std::uint32_t every) noexcept;
+        // 快照与重置均可在其他线程调用，重置在本线程下一轮事件循环开始时生效
+        StageHistograms::Snapshot stageLatency() const noexcept { return this->mStages_.snapshot(); }
+        void resetStageLatency() noexcept { this->mStages_.reset(); }
+
+        FrameArena& frameArena() noexcept { return this->mFrameArena_; }
+        FrameArenaStats frameArenaStats() const noexcept { return this->mFrameArena_.stats(); }
 
     private:
+        FrameArena mFrameArena_;    // 须先于mTasks_构造、后于其析构
         EventQueue mEventQueue_;
         ErrorCallback mErrCb_;
         IoEventCallback mReadCb_, mWriteCb_;
-        std::unordered_map<Connection*, AsyncTask> mConns_;
+        ConnectionHandler mHandler_;
+        bool mKeepAlive_{false};
+        std::size_t mWriteHighWater_{0};
+        HighWaterCallback mHighWaterCb_;
+        ConnectionSlab mSlab_;
+        std::vector<AsyncTask> mTasks_;     // 与mSlab_按槽位下标一一对应
+        std::chrono::milliseconds mShrinkIdleTime_{0};
+        std::size_t mShrinkHighWaterBytes_{static_cast<std::size_t>(-1)};
+        TimeoutEvent mShrinkTimer_;
+        bool mShrinkTimerArmed_{false};
+        Timer mTimer_;
+        std::chrono::milliseconds mTimerResolution_{100};
+        TimeoutEvent mTimerTick_;
+        bool mTimerTickArmed_{false};
+        std::chrono::steady_clock::time_point mLoopNow_{};     // 本轮事件循环取得完成事件后的时间
+        detail::TimerSlab mTimerSlab_;
+        WakeupEvent mWakeup_;
+        bool mWakeupArmed_{false};
+        std::vector<Connection*> mCloseRetries_;        // 提交队列满、关闭未能提交的连接，保持CLOSING
+        struct PostedTask
+        {
+            PostCallback fn;
+            std::chrono::steady_clock::time_point enqueued;
+        };
+        detail::BoundedMpscQueue<PostedTask> mTaskQueue_{PostQueueCapacity};
+        std::atomic<bool> mWakeupPending_{false};      // 已发出唤醒、所属线程尚未取走
+        LatencyHistogram mPostLatency_;
+        MetricsBlock mMetrics_;
+        StageHistograms mStages_;
+        ComputePool* mComputePool_{nullptr};
+        detail::MpscQueue mPosted_;
+        std::atomic<std::size_t> mPostedDepth_{0};
+        std::atomic<std::size_t> mPeakPostedDepth_{0};
+        std::atomic<std::size_t> mActiveConns_{0};     // 含投递中尚未接管的连接
+        std::atomic<std::uint64_t> mBusyNs_{0};
+        std::chrono::milliseconds mMigrateInterval_{0};
+        MigrationTargetFn mMigrateTarget_;
+        TimeoutEvent mMigrateTimer_;
+        bool mMigrateTimerArmed_{false};
+        std::uint64_t mBusySnapshot_{0};
+        std::atomic<std::uint64_t> mRecentBusyNs_{0};
+        std::atomic<std::uint64_t> mMigratedOut_{0};
+        std::atomic<std::uint64_t> mMigratedIn_{0};
         
+        void postConnection(Connection* conn, bool migrated);
+        void adoptConnection(Connection* conn, bool migrated);
+        void runPostedTasks();
+        // 队列满时唤醒所属线程并退避休眠后重试，仍失败则返回false并销毁fn
+        bool postRetrying(PostCallback fn);
+        void signalWakeup() noexcept;
+        void resumePosted();
+        TimerId scheduleTimer(std::chrono::steady_clock::time_point deadline, std::chrono::milliseconds interval, TimerCallback cb);
+        void onTimer(detail::TimerEntry* entry);
+        bool dispatchPipelined(Connection* conn);
+        void checkHighWater(Connection* conn);
+        void releaseSlot(Connection* conn);
+        void requestMigration();
+        void migrateOut(Connection* conn);
         void closeConnection(Connection* conn);
+        void retryCloses();
+        void trimBuffer(ChainBuffer& buf);
+        void shrinkIdleBuffers();
         AsyncTask asyncHandle(Connection* conn);
+        Task<> asyncHandleKeepAlive(Connection* conn);
     };
 }   // namespace blitz
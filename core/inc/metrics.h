@@ -0,0 +1,83 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace blitz
+{
+    enum class Metric : std::uint8_t
+    {
+        ACCEPTS = 0,            // 主线程为接受的连接数，IO线程为接管的新连接数
+        ACTIVE_CONNECTIONS,     // 瞬时值
+        BYTES_IN,
+        BYTES_OUT,
+        SQES_SUBMITTED,
+        URING_ENTERS,           // 提交与阻塞等待完成事件各计一次
+        CQES_REAPED,
+        CQE_WAITS,              // 阻塞等待次数，CQES_REAPED / CQE_WAITS 即每次等待取得的完成事件数
+        SUBMIT_QUEUE_FULL,
+        TIMER_FIRES,            // 连接超时与通用定时器到期
+        COUNT
+    };
+
+    constexpr static std::size_t MetricNum = static_cast<std::size_t>(Metric::COUNT);
+
+    struct MetricsSnapshot
+    {
+        std::array<std::uint64_t, MetricNum> values{};
+
+        std::uint64_t operator[](Metric m) const noexcept { return this->values[static_cast<std::size_t>(m)]; }
+        std::uint64_t& operator[](Metric m) noexcept { return this->values[static_cast<std::size_t>(m)]; }
+
+        MetricsSnapshot& operator+=(const MetricsSnapshot& rhs) noexcept
+        {
+            for (std::size_t i = 0; i < MetricNum; ++i)
+            {
+                this->values[i] += rhs.values[i];
+            }
+            return *this;
+        }
+    };
+
+    // 单写者计数块：只由所属事件循环线程写入，其他线程可随时读取
+    // 按缓存行对齐，各线程的计数块互不共享缓存行，写入只是普通的load/store
+    class alignas(64) MetricsBlock
+    {
+    public:
+        void add(Metric m, std::uint64_t n = 1) noexcept
+        {
+            auto& counter = this->mValues_[static_cast<std::size_t>(m)];
+            counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+
+        void set(Metric m, std::uint64_t value) noexcept
+        {
+            this->mValues_[static_cast<std::size_t>(m)].store(value, std::memory_order_relaxed);
+        }
+
+        // 累加到out，聚合时逐块调用
+        void collect(MetricsSnapshot& out) const noexcept
+        {
+            for (std::size_t i = 0; i < MetricNum; ++i)
+            {
+                out.values[i] += this->mValues_[i].load(std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        std::array<std::atomic<std::uint64_t>, MetricNum> mValues_{};
+    };
+
+    // 一个事件循环的指标，label作为loop标签的值
+    struct LoopMetrics
+    {
+        std::string label;
+        MetricsSnapshot snapshot;
+    };
+
+    // 渲染为Prometheus文本格式（0.0.4）：每个事件循环一个样本，附带进程级的缓冲区占用
+    std::string RenderPrometheus(std::span<const LoopMetrics> loops);
+}   // namespace blitz
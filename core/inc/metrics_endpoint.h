@@ -0,0 +1,58 @@
+#pragma once
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "acceptor.h"
+
+namespace blitz
+{
+    // 旁路端口上的Prometheus文本端点：读完请求头后返回render()的结果并关闭连接，每次收发超时即关闭
+    // 监听与会话均为ENDPOINT事件，由所在事件循环取得后交给onEvent()，无需额外线程
+    class MetricsEndpoint
+    {
+    public:
+        using RenderFn = std::function<std::string()>;
+
+        // 监听失败时抛出异常
+        MetricsEndpoint(EventQueue& eq, std::uint16_t port, RenderFn render);
+        MetricsEndpoint(const MetricsEndpoint&) = delete;
+        MetricsEndpoint& operator=(const MetricsEndpoint&) = delete;
+        ~MetricsEndpoint();
+
+        void onEvent(Event* ev);
+
+    private:
+        enum class Stage : std::uint8_t
+        {
+            READ = 0,
+            WRITE,
+            CLOSE
+        };
+
+        struct Session : Event
+        {
+            explicit Session(SocketDescriptor sock) : Event{sock} { this->setEvent(EventType::ENDPOINT); }
+
+            Stage stage{Stage::READ};
+            std::size_t index{0};       // 在mSessions_中的下标
+            std::size_t received{0};
+            std::array<char, 2048> request;
+            std::string response;
+            std::size_t sent{0};
+        };
+
+        EventQueue& mEventQueue_;
+        Acceptor mAcceptor_;
+        RenderFn mRender_;
+        std::vector<std::unique_ptr<Session>> mSessions_;
+
+        void onAccept(std::int32_t res);
+        void onRead(Session* session, std::int32_t res);
+        void onWrite(Session* session, std::int32_t res);
+        void respond(Session* session);
+        void closeSession(Session* session);
+        void destroySession(Session* session);
+    };
+}   // namespace blitz
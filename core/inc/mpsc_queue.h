@@ -0,0 +1,150 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace blitz
+{
+    namespace detail
+    {
+        struct MpscNode
+        {
+            std::atomic<MpscNode*> next{nullptr};
+        };
+
+        // 侵入式无锁多生产者单消费者队列（Vyukov算法）：push可在任意线程调用，pop只在所属线程调用
+        // 节点内存由调用方管理，出队前须保持有效
+        class MpscQueue
+        {
+        public:
+            MpscQueue() : mHead_{&mStub_}, mTail_{&mStub_} {}
+            MpscQueue(const MpscQueue&) = delete;
+            MpscQueue& operator=(const MpscQueue&) = delete;
+
+            void push(MpscNode* node) noexcept
+            {
+                node->next.store(nullptr, std::memory_order_relaxed);
+                MpscNode* prev = this->mHead_.exchange(node, std::memory_order_acq_rel);
+                prev->next.store(node, std::memory_order_release);
+            }
+
+            // 队列为空或有生产者尚未完成入队时返回nullptr；后者的生产者入队后会再次唤醒消费者
+            MpscNode* pop() noexcept
+            {
+                MpscNode* tail = this->mTail_;
+                MpscNode* next = tail->next.load(std::memory_order_acquire);
+                if (tail == &this->mStub_)
+                {
+                    if (!next)  return nullptr;
+                    this->mTail_ = next;
+                    tail = next;
+                    next = next->next.load(std::memory_order_acquire);
+                }
+                if (next)
+                {
+                    this->mTail_ = next;
+                    return tail;
+                }
+                if (tail != this->mHead_.load(std::memory_order_acquire))
+                {
+                    return nullptr;
+                }
+                this->push(&this->mStub_);
+                next = tail->next.load(std::memory_order_acquire);
+                if (next)
+                {
+                    this->mTail_ = next;
+                    return tail;
+                }
+                return nullptr;
+            }
+
+        private:
+            std::atomic<MpscNode*> mHead_;
+            MpscNode* mTail_;
+            MpscNode mStub_;
+        };
+
+        // 有界无锁多生产者单消费者队列（Vyukov有界队列）：元素就地存放在预分配的环形数组中，入队不分配内存
+        // 每个槽位的序号表明其可写（等于入队位置）或可读（等于入队位置+1），容量须为2的幂
+        template<typename T>
+        class BoundedMpscQueue
+        {
+        public:
+            explicit BoundedMpscQueue(std::size_t capacity)
+                : mMask_{capacity - 1}, mCells_{std::make_unique<Cell[]>(capacity)}, mEnqueuePos_{0}, mDequeuePos_{0}
+            {
+                for (std::size_t i = 0; i < capacity; ++i)
+                {
+                    this->mCells_[i].seq.store(i, std::memory_order_relaxed);
+                }
+            }
+            BoundedMpscQueue(const BoundedMpscQueue&) = delete;
+            BoundedMpscQueue& operator=(const BoundedMpscQueue&) = delete;
+
+            // 任意线程调用，队列满时返回false
+            template<typename U>
+            bool tryPush(U&& value)
+            {
+                std::size_t pos = this->mEnqueuePos_.load(std::memory_order_relaxed);
+                for (;;)
+                {
+                    Cell& cell = this->mCells_[pos & this->mMask_];
+                    std::size_t seq = cell.seq.load(std::memory_order_acquire);
+                    auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+                    if (0 == diff)
+                    {
+                        if (this->mEnqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            cell.value = std::forward<U>(value);
+                            cell.seq.store(pos + 1, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if (diff < 0)
+                    {
+                        return false;
+                    }
+                    else
+                    {
+                        pos = this->mEnqueuePos_.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            // 仅所属线程调用；队列为空或队首的生产者尚未写完时返回false，后者写完后会再次唤醒消费者
+            bool tryPop(T& out)
+            {
+                std::size_t pos = this->mDequeuePos_.load(std::memory_order_relaxed);
+                Cell& cell = this->mCells_[pos & this->mMask_];
+                if (cell.seq.load(std::memory_order_acquire) != pos + 1)   return false;
+                out = std::move(cell.value);
+                cell.seq.store(pos + this->mMask_ + 1, std::memory_order_release);
+                this->mDequeuePos_.store(pos + 1, std::memory_order_relaxed);
+                return true;
+            }
+
+            // 近似深度，可在任意线程读取
+            std::size_t sizeApprox() const noexcept
+            {
+                std::size_t enq = this->mEnqueuePos_.load(std::memory_order_relaxed);
+                std::size_t deq = this->mDequeuePos_.load(std::memory_order_relaxed);
+                return (enq > deq) ? enq - deq : 0;
+            }
+
+        private:
+            struct Cell
+            {
+                std::atomic<std::size_t> seq;
+                T value;
+            };
+
+            std::size_t mMask_;
+            std::unique_ptr<Cell[]> mCells_;
+            alignas(64) std::atomic<std::size_t> mEnqueuePos_;
+            alignas(64) std::atomic<std::size_t> mDequeuePos_;     // 仅消费者写入，原子类型供其他线程读取深度
+        };
+    }   // namespace detail
+}   // namespace blitz
@@ -0,0 +1,56 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace blitz
+{
+    // 新连接在IoService之间的分配策略
+    enum class PlacementPolicy : std::uint8_t
+    {
+        ROUND_ROBIN = 0,
+        LEAST_CONNECTIONS,      // 当前连接数最少；请求耗时偏斜时只看连接数会把重连接扎堆，p99劣于轮转
+        LEAST_CPU,              // 最近一个采样窗口内处理耗时最少
+        POWER_OF_TWO_CHOICES,   // 随机取两个，选连接数较少者
+    };
+
+    // IoService对外发布的负载计数，由其所属线程无锁更新，接收线程读取
+    struct IoServiceLoad
+    {
+        std::size_t activeConnections;
+        std::uint64_t busyNs;       // 处理完成事件的累计耗时
+    };
+
+    // 连接迁移判定：源负载超过目标的imbalanceRatio倍，且迁走该连接后源仍不低于目标（connCpu < (src - dst) / 2）；
+    // 后者即迟滞条件，否则一个占主导的热点连接迁走后目标成为最忙者，下个周期又被迁回
+    bool ShouldMigrate(std::uint64_t srcBusyNs, std::uint64_t dstBusyNs, std::uint64_t connCpuNs, double imbalanceRatio) noexcept;
+
+    // 根据各IoService的负载快照选择下一个连接的归属，仅在接收连接的线程上调用
+    class PlacementPicker
+    {
+    public:
+        constexpr static std::chrono::milliseconds CpuSampleWindow{100};
+
+        explicit PlacementPicker(PlacementPolicy policy = PlacementPolicy::ROUND_ROBIN);
+
+        void setPolicy(PlacementPolicy policy) noexcept { this->mPolicy_ = policy; }
+        PlacementPolicy policy() const noexcept { return this->mPolicy_; }
+        std::size_t pick(std::span<const IoServiceLoad> loads, std::chrono::steady_clock::time_point now);
+
+    private:
+        PlacementPolicy mPolicy_;
+        std::size_t mNextIdx_;
+        std::uint64_t mRandState_;
+        std::chrono::steady_clock::time_point mLastSample_;
+        std::vector<std::uint64_t> mBusySnapshot_;
+        std::vector<std::uint64_t> mRecentBusy_;        // 上一个采样窗口内的耗时
+        std::vector<std::size_t> mPlacedInWindow_;      // 本窗口内新分配的连接数
+
+        std::size_t pickLeastConnections(std::span<const IoServiceLoad> loads);
+        std::size_t pickLeastCpu(std::span<const IoServiceLoad> loads, std::chrono::steady_clock::time_point now);
+        std::size_t pickPowerOfTwo(std::span<const IoServiceLoad> loads);
+        std::uint64_t nextRandom() noexcept;
+    };
+}   // namespace blitz
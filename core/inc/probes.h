@@ -0,0 +1,23 @@
+#pragma once
+
+// USDT静态探针，provider为blitz：可由bpftrace/perf按 usdt:<可执行文件>:blitz:<探针名> 附加，无需重新编译
+// 系统提供<sys/sdt.h>时探针编译为一条nop与ELF note，未附加时只有参数求值的开销，参数均取已在寄存器或缓存中的值；
+// 否则（或定义了BLITZ_DISABLE_USDT）展开为空
+#if defined(__linux__) && !defined(BLITZ_DISABLE_USDT)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define BLITZ_HAS_USDT 1
+#endif
+#endif
+
+#ifdef BLITZ_HAS_USDT
+#define BLITZ_PROBE0(name) DTRACE_PROBE(blitz, name)
+#define BLITZ_PROBE1(name, a1) DTRACE_PROBE1(blitz, name, a1)
+#define BLITZ_PROBE2(name, a1, a2) DTRACE_PROBE2(blitz, name, a1, a2)
+#define BLITZ_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(blitz, name, a1, a2, a3)
+#else
+#define BLITZ_PROBE0(name) do {} while (0)
+#define BLITZ_PROBE1(name, a1) do {} while (0)
+#define BLITZ_PROBE2(name, a1, a2) do {} while (0)
+#define BLITZ_PROBE3(name, a1, a2, a3) do {} while (0)
+#endif
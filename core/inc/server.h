@@ -2,8 +2,8 @@
 #include <cstddef>
 #include <memory>
 #include "acceptor.h"
+#include "metrics_endpoint.h"
 #include "threadpool.h"
-#include "timer.h"
 
 #ifdef __linux__
     #define SIGNAL_NUM 32
@@ -18,24 +18,57 @@ namespace blitz
     public:
         TcpServer(std::size_t threadNum, std::uint16_t port, int backlog = 5);
 
-        void run(std::chrono::milliseconds tickMs);
+        // tickMs为各IO线程检查连接超时的间隔；IO线程启动失败时返回错误，否则在stop()后返回Success
+        std::error_code run(std::chrono::milliseconds tickMs);
         void stop();
 
         void setReadCallback(IoEventCallback cb) noexcept;
         void setWriteCallback(IoEventCallback cb) noexcept;
         void setErrorCallback(ErrorCallback cb) noexcept;
+        // 以协程方式处理每个连接，设置后读写回调不再生效
+        void setConnectionHandler(ConnectionHandler handler) noexcept;
+        // 长连接模式：同一连接上循环处理请求，已到达的流水线请求连续处理、响应合并写出
+        void setKeepAlive(bool on) noexcept;
+        // 写缓冲区积压超过bytes时调用cb（协程方式下asyncWrite改为挂起等待写完），用于流式发送的背压
+        void setWriteHighWater(std::size_t bytes, HighWaterCallback cb) noexcept;
         void setSignalCallback(int sig, SignalCallback cb) noexcept;
+        // timeoutMs为空闲超时，每次读写完成后重新计时
         void setTimeoutCallback(TimeoutCallback cb, std::chrono::milliseconds timeoutMs) noexcept;
+        // 读/写超时：有在途读/写且该方向持续无完成，到期同样调用超时回调
+        void setIoTimeouts(std::chrono::milliseconds readMs, std::chrono::milliseconds writeMs) noexcept { this->mPool_->setIoTimeouts(readMs, writeMs); }
+        LatencyHistogram::Snapshot postLatency() const noexcept { return this->mPool_->postLatency(); }
+        void setBufferShrinkPolicy(std::chrono::milliseconds idleTime, std::size_t highWaterBytes) noexcept;
+        // 读回调交给threadNum个计算线程执行，慢回调不再阻塞IO线程；须在run前调用
+        void setHandlerOffload(std::size_t threadNum);
+        void setPlacementPolicy(PlacementPolicy policy) noexcept { this->mPool_->setPlacementPolicy(policy); }
+        // 将负载过高的IoService上处于请求间空闲状态的热点长连接迁往最空闲的IoService；须在run前调用
+        void setMigrationPolicy(std::chrono::milliseconds interval, double imbalanceRatio) { this->mPool_->setMigrationPolicy(interval, imbalanceRatio); }
+        // IO线程绑核策略，须在run前调用
+        void setAffinity(AffinityPolicy policy, std::vector<int> cpuList = {}) noexcept { this->mPool_->setAffinity(policy, std::move(cpuList)); }
+        // 将运行accept循环的主线程绑定到cpu，该CPU不再分配给IO线程；须在run前调用
+        void setMainThreadCpu(int cpu) noexcept;
+        std::uint64_t migratedConnections() const noexcept { return this->mPool_->migratedConnections(); }
+        ComputePoolStats computePoolStats() const noexcept { return this->mPool_->computePoolStats(); }
+        // 主线程accept循环与各IO线程的计数之和
+        MetricsSnapshot metrics() const noexcept;
+        // 请求各阶段延迟（对数-线性直方图）：每every个事件采样一次，0表示关闭（默认）；须在run前调用
+        // REGISTER阶段沿用ACCEPT阶段的采样结果
+        void setStageSampling(std::uint32_t every) noexcept;
+        // 主线程与各IO线程合并后的快照；重置可在任意线程调用，各线程在下一轮事件循环开始时清零
+        StageHistograms::Snapshot stageLatency() const noexcept;
+        void resetStageLatency() noexcept;
+        // 在port上提供Prometheus文本格式的指标，由主线程的事件循环处理；须在run前调用，监听失败时抛出异常
+        void enableMetricsEndpoint(std::uint16_t port);
     
     private:
         EventQueue mMainEventQueue_;
         Acceptor mAcceptor_;
-        Timer mTimer_;
         std::unique_ptr<IoServicePool> mPool_;
+        std::unique_ptr<MetricsEndpoint> mMetricsEndpoint_;
+        StageHistograms mStages_;      // 主线程记录的ACCEPT阶段
+        int mMainCpu_;
         SignalCallback mSignalCbs_[SIGNAL_NUM];
         bool isStopLoop_;
-
-        void startTimer(std::chrono::milliseconds tickMs);
     };
 }   // namespace blitz
 #undef SIGNAL_NUM
@@ -0,0 +1,130 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "histogram.h"
+
+namespace blitz
+{
+    // 请求生命周期中的各阶段，均在已有的事件边界上计时
+    enum class Stage : std::uint8_t
+    {
+        ACCEPT = 0,     // accept完成 -> 注册到IoService（主线程）
+        REGISTER,       // 注册 -> 所属IO线程接管
+        READ,           // 提交读 -> 读完成
+        HANDLER,        // 读回调执行；卸载到计算线程时为投递到恢复
+        WRITE,          // 首次提交写 -> 写缓冲区清空
+        RESPONSE,       // 读完成 -> 响应写完
+        CLOSE,          // 提交关闭 -> 关闭完成
+        COUNT
+    };
+
+    constexpr static std::size_t StageNum = static_cast<std::size_t>(Stage::COUNT);
+
+    namespace detail
+    {
+        // 连接上各阶段的起点（steady_clock纳秒），0表示本次未采样
+        struct StageStamps
+        {
+            std::uint64_t accepted{0};
+            std::uint64_t registered{0};
+            std::uint64_t readSubmitted{0};
+            std::uint64_t readCompleted{0};
+            std::uint64_t writeSubmitted{0};
+            std::uint64_t closeSubmitted{0};
+        };
+    }   // namespace detail
+
+    // 一个事件循环线程的各阶段延迟直方图：只由该线程记录，快照可跨线程读取、按阶段合并
+    // 按阶段各自计数采样，未被采样的事件不读取时钟
+    class StageHistograms
+    {
+    public:
+        struct Snapshot
+        {
+            std::array<LogLinearHistogram::Snapshot, StageNum> stages{};
+
+            const LogLinearHistogram::Snapshot& operator[](Stage s) const noexcept { return this->stages[static_cast<std::size_t>(s)]; }
+
+            Snapshot& operator+=(const Snapshot& rhs) noexcept
+            {
+                for (std::size_t i = 0; i < StageNum; ++i)
+                {
+                    this->stages[i] += rhs.stages[i];
+                }
+                return *this;
+            }
+        };
+
+        static std::uint64_t Now() noexcept
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        // 每every个事件采样一次（向上取整为2的幂），0表示不采样；须在事件循环启动前设置
+        void setSampling(std::uint32_t every) noexcept
+        {
+            this->mEnabled_ = (every > 0);
+            this->mSampleMask_ = this->mEnabled_ ? std::bit_ceil(every) - 1 : 0;
+        }
+
+        bool enabled() const noexcept { return this->mEnabled_; }
+
+        // 是否对本次事件计时
+        bool sample(Stage s) noexcept
+        {
+            if (!this->mEnabled_)   return false;
+            return 0 == (this->mTicks_[static_cast<std::size_t>(s)]++ & this->mSampleMask_);
+        }
+
+        void record(Stage s, std::uint64_t ns) noexcept
+        {
+            this->mHists_[static_cast<std::size_t>(s)].record(ns);
+        }
+
+        // 从start记录到当前，start为0（未采样）时忽略；返回当前时间，未读取时钟时为0
+        std::uint64_t recordSince(Stage s, std::uint64_t start) noexcept
+        {
+            if (0 == start) return 0;
+            auto now = Now();
+            this->record(s, now - start);
+            return now;
+        }
+
+        // 按值返回StageNum个LogLinearHistogram快照（约33KB），逐桶读取原子计数，
+        // 开销与抓取频率成正比，不影响记录路径；适合按秒级周期抓取，不宜在热路径上调用
+        Snapshot snapshot() const noexcept
+        {
+            Snapshot s;
+            for (std::size_t i = 0; i < StageNum; ++i)
+            {
+                s.stages[i] = this->mHists_[i].snapshot();
+            }
+            return s;
+        }
+
+        // 可在任意线程调用：只置标记，由所属线程在下一轮事件循环取得完成事件后清零（记录者始终只有一个）。
+        // 因此reset()返回后、所属线程处理下一个事件之前，快照仍是旧值；事件循环空闲时清零推迟到下一个事件
+        void reset() noexcept { this->mResetPending_.store(true, std::memory_order_release); }
+
+        void applyPendingReset() noexcept
+        {
+            if (!this->mResetPending_.load(std::memory_order_relaxed))  return;
+            if (!this->mResetPending_.exchange(false, std::memory_order_acquire))   return;
+            for (auto& hist : this->mHists_)
+            {
+                hist.reset();
+            }
+        }
+
+    private:
+        std::array<LogLinearHistogram, StageNum> mHists_;
+        std::array<std::uint32_t, StageNum> mTicks_{};
+        std::uint32_t mSampleMask_{0};
+        bool mEnabled_{false};
+        std::atomic<bool> mResetPending_{false};
+    };
+}   // namespace blitz
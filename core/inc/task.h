@@ -0,0 +1,301 @@
+#pragma once
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include "event_queue.h"
+#include "frame_arena.h"
+#include "timer_slab.h"
+
+namespace blitz
+{
+    template <typename T>
+    class Task;
+    class IoService;
+
+    namespace detail
+    {
+        // 协程结束时对称转移回等待它的协程
+        template <typename Promise>
+        struct TaskFinalAwaiter
+        {
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+            {
+                if (auto continuation = handle.promise().continuation; continuation)
+                {
+                    return continuation;
+                }
+                return std::noop_coroutine();
+            }
+            void await_resume() const noexcept {}
+        };
+
+        struct TaskPromiseBase
+        {
+            std::coroutine_handle<> continuation;
+            std::exception_ptr exception;
+
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            void unhandled_exception() noexcept { this->exception = std::current_exception(); }
+
+            // 协程帧从当前线程IoService的内存池分配
+            static void* operator new(std::size_t size) { return FrameArena::Allocate(CurrentFrameArena(), size); }
+            static void operator delete(void* frame) noexcept { FrameArena::Deallocate(frame); }
+        };
+
+        template <typename T>
+        struct TaskPromise : TaskPromiseBase
+        {
+            std::optional<T> value;
+
+            template <typename U>
+            void return_value(U&& v) { this->value.emplace(std::forward<U>(v)); }
+        };
+
+        template <>
+        struct TaskPromise<void> : TaskPromiseBase
+        {
+            void return_void() noexcept {}
+        };
+
+        // 当前线程正在驱动的EventQueue，供不绑定连接的awaitable（如sleep）提交操作
+        EventQueue*& CurrentEventQueue() noexcept;
+
+        class CurrentEventQueueGuard
+        {
+        public:
+            explicit CurrentEventQueueGuard(EventQueue* q) : mPrev_{CurrentEventQueue()} { CurrentEventQueue() = q; }
+            ~CurrentEventQueueGuard() { CurrentEventQueue() = this->mPrev_; }
+
+        private:
+            EventQueue* mPrev_;
+        };
+
+        // 当前线程正在驱动的IoService，供sleep经其定时器槽位表安排超时
+        IoService*& CurrentIoService() noexcept;
+
+        class CurrentIoServiceGuard
+        {
+        public:
+            explicit CurrentIoServiceGuard(IoService* service) : mPrev_{CurrentIoService()} { CurrentIoService() = service; }
+            ~CurrentIoServiceGuard() { CurrentIoService() = this->mPrev_; }
+
+        private:
+            IoService* mPrev_;
+        };
+    }   // namespace detail
+
+    // 用户处理逻辑的协程类型：惰性启动，被co_await时开始执行，结束后恢复等待者
+    template <typename T = void>
+    class Task
+    {
+    public:
+        struct promise_type : detail::TaskPromise<T>
+        {
+            Task get_return_object() { return Task{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+            detail::TaskFinalAwaiter<promise_type> final_suspend() noexcept { return {}; }
+        };
+
+        Task() = default;
+        explicit Task(std::coroutine_handle<promise_type> hdl) : mCoroutineHandle_{hdl} {}
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+        Task(Task&& rhs) : mCoroutineHandle_{std::exchange(rhs.mCoroutineHandle_, {})} {}
+        Task& operator=(Task&& rhs)
+        {
+            if (this != &rhs)
+            {
+                if (this->mCoroutineHandle_)
+                {
+                    this->mCoroutineHandle_.destroy();
+                }
+                this->mCoroutineHandle_ = std::exchange(rhs.mCoroutineHandle_, {});
+            }
+            return *this;
+        }
+        ~Task()
+        {
+            if (this->mCoroutineHandle_)
+            {
+                this->mCoroutineHandle_.destroy();
+            }
+        }
+
+        bool await_ready() const noexcept { return !this->mCoroutineHandle_ || this->mCoroutineHandle_.done(); }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+        {
+            this->mCoroutineHandle_.promise().continuation = awaiting;
+            return this->mCoroutineHandle_;
+        }
+
+        T await_resume()
+        {
+            auto& promise = this->mCoroutineHandle_.promise();
+            if (promise.exception)
+            {
+                std::rethrow_exception(promise.exception);
+            }
+            if constexpr (!std::is_void_v<T>)
+            {
+                return std::move(*promise.value);
+            }
+        }
+
+    private:
+        std::coroutine_handle<promise_type> mCoroutineHandle_;
+    };
+
+    namespace detail
+    {
+        struct WhenAllState
+        {
+            int remaining;
+            std::coroutine_handle<> continuation;
+            std::exception_ptr exception;
+        };
+
+        // whenAll的子任务：立即开始执行，结束时停在最终挂起点，由WhenAllAwaiter销毁
+        // 父协程帧在子任务挂起期间被销毁（如连接关闭）时，子任务帧及其持有的Task随之销毁，不会遗留在内存池中
+        class WhenAllChild
+        {
+        public:
+            struct promise_type
+            {
+                WhenAllState* state;
+
+                promise_type(Task<>&, WhenAllState* s) noexcept : state{s} {}
+
+                WhenAllChild get_return_object() noexcept { return WhenAllChild{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+                std::suspend_never initial_suspend() noexcept { return {}; }
+                // 已停在最终挂起点后才计数并恢复父协程，父协程随即销毁本帧也是安全的
+                auto final_suspend() noexcept
+                {
+                    struct FinalAwaiter
+                    {
+                        bool await_ready() const noexcept { return false; }
+                        std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+                        {
+                            auto* state = handle.promise().state;
+                            if (0 == --state->remaining)    return state->continuation;
+                            return std::noop_coroutine();
+                        }
+                        void await_resume() const noexcept {}
+                    };
+                    return FinalAwaiter{};
+                }
+                void return_void() noexcept {}
+                void unhandled_exception() noexcept {}
+
+                static void* operator new(std::size_t size) { return FrameArena::Allocate(CurrentFrameArena(), size); }
+                static void operator delete(void* frame) noexcept { FrameArena::Deallocate(frame); }
+            };
+
+            WhenAllChild() = default;
+            explicit WhenAllChild(std::coroutine_handle<promise_type> hdl) : mCoroutineHandle_{hdl} {}
+            WhenAllChild(const WhenAllChild&) = delete;
+            WhenAllChild& operator=(const WhenAllChild&) = delete;
+            WhenAllChild(WhenAllChild&& rhs) noexcept : mCoroutineHandle_{std::exchange(rhs.mCoroutineHandle_, {})} {}
+            WhenAllChild& operator=(WhenAllChild&& rhs) noexcept
+            {
+                if (this != &rhs)
+                {
+                    if (this->mCoroutineHandle_)
+                    {
+                        this->mCoroutineHandle_.destroy();
+                    }
+                    this->mCoroutineHandle_ = std::exchange(rhs.mCoroutineHandle_, {});
+                }
+                return *this;
+            }
+            ~WhenAllChild()
+            {
+                if (this->mCoroutineHandle_)
+                {
+                    this->mCoroutineHandle_.destroy();
+                }
+            }
+
+        private:
+            std::coroutine_handle<promise_type> mCoroutineHandle_;
+        };
+
+        inline WhenAllChild RunAndSignal(Task<> task, WhenAllState* state)
+        {
+            try
+            {
+                co_await task;
+            }
+            catch (...)
+            {
+                if (!state->exception)  state->exception = std::current_exception();
+            }
+        }
+
+        // 位于父协程帧中，持有两个子任务，随父协程帧一同销毁
+        class WhenAllAwaiter
+        {
+        public:
+            WhenAllAwaiter(Task<>& a, Task<>& b) : mState_{0, {}, nullptr}, mA_{a}, mB_{b} {}
+
+            bool await_ready() const noexcept { return false; }
+            bool await_suspend(std::coroutine_handle<> handle)
+            {
+                // 计数多占一位，防止子任务同步完成时在await_suspend返回前恢复调用方
+                this->mState_.remaining = 3;
+                this->mState_.continuation = handle;
+                this->mChildren_[0] = RunAndSignal(std::move(this->mA_), &this->mState_);
+                this->mChildren_[1] = RunAndSignal(std::move(this->mB_), &this->mState_);
+                return 0 != --this->mState_.remaining;
+            }
+            void await_resume() const
+            {
+                if (this->mState_.exception)
+                {
+                    std::rethrow_exception(this->mState_.exception);
+                }
+            }
+
+        private:
+            WhenAllState mState_;
+            Task<>& mA_;
+            Task<>& mB_;
+            WhenAllChild mChildren_[2];
+        };
+    }   // namespace detail
+
+    // 并发执行两个任务，二者都结束后返回；用于同一连接上边读边写，任一任务抛出的异常在此重新抛出
+    inline Task<> whenAll(Task<> a, Task<> b)
+    {
+        co_await detail::WhenAllAwaiter{a, b};
+    }
+
+    // 挂起当前协程指定时长，由所在IoService的定时器（runAfter）唤醒
+    // 超时操作的user_data指向定时器槽位而非协程帧：挂起期间协程帧被销毁（如连接关闭）时取消定时器，到期事件按代数作废
+    class SleepAwaiter
+    {
+    public:
+        explicit SleepAwaiter(std::chrono::milliseconds timeoutMs) : mTimeoutMs_{timeoutMs} {}
+        SleepAwaiter(const SleepAwaiter&) = delete;
+        SleepAwaiter& operator=(const SleepAwaiter&) = delete;
+        ~SleepAwaiter();
+
+        bool await_ready() const noexcept;
+        bool await_suspend(std::coroutine_handle<> handle) noexcept;
+        void await_resume() const noexcept {}
+
+    private:
+        std::chrono::milliseconds mTimeoutMs_;
+        IoService* mService_{nullptr};      // 定时器未到期时非空
+        TimerId mTimer_;
+    };
+
+    inline SleepAwaiter sleep(std::chrono::milliseconds timeoutMs) { return SleepAwaiter{timeoutMs}; }
+
+    class Connection;
+    using ConnectionHandler = std::function<Task<>(Connection* conn)>;
+}   // namespace blitz
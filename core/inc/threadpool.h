@@ -1,13 +1,21 @@
 #pragma once
+#include <chrono>
+#include <memory>
 #include <thread>
 #include <vector>
+#include "affinity.h"
 #include "common.h"
+#include "compute_pool.h"
+#include "frame_arena.h"
+#include "histogram.h"
+#include "placement.h"
+#include "task.h"
+#include "timer.h"
 
 namespace blitz
 {
     class Connection;
     class IoService;
-    class Timer;
 
     class IoServicePool
     {
@@ -15,17 +23,58 @@ namespace blitz
         IoServicePool(std::size_t threadNum);
         ~IoServicePool();
         
-        void start(Timer& t);
+        // 启动IO线程；某线程重建ring失败时停止已启动的线程并返回错误
+        std::error_code start();
         void putNewConnection(Connection* conn);
 
         void setReadCallback(IoEventCallback cb) noexcept;
         void setWriteCallback(IoEventCallback cb) noexcept;
         void setErrorCallback(ErrorCallback cb) noexcept;
+        void setConnectionHandler(ConnectionHandler handler) noexcept;
+        void setKeepAlive(bool on) noexcept;
+        void setWriteHighWater(std::size_t bytes, HighWaterCallback cb) noexcept;
+        void setBufferShrinkPolicy(std::chrono::milliseconds idleTime, std::size_t highWaterBytes) noexcept;
+        // 各IoService独立计时，回调在连接所属的IO线程中执行
+        void setTimeoutCallback(TimeoutCallback cb, std::chrono::milliseconds timeoutMs) noexcept;
+        void setTimerResolution(std::chrono::milliseconds resolution) noexcept;
+        void setIoTimeouts(std::chrono::milliseconds readMs, std::chrono::milliseconds writeMs) noexcept;
+        // 汇总所有IoService的协程帧分配统计
+        FrameArenaStats frameArenaStats() const noexcept;
+        // 创建threadNum个计算线程执行读回调，执行完毕后回到所属IO线程继续写出；须在start前调用
+        void setHandlerOffload(std::size_t threadNum);
+        // 新连接的分配策略，默认轮询
+        void setPlacementPolicy(PlacementPolicy policy) noexcept { this->mPicker_.setPolicy(policy); }
+        // 每interval检查一次：某IoService的周期耗时超过最空闲者的imbalanceRatio倍时，迁出其最热的空闲长连接；须在start前调用
+        void setMigrationPolicy(std::chrono::milliseconds interval, double imbalanceRatio);
+        // 累计迁移的连接数
+        std::uint64_t migratedConnections() const noexcept;
+        // IO线程绑核策略：线程启动后先绑核再重建ring，使ring与后续分配的缓冲区位于本地节点；须在start前调用
+        void setAffinity(AffinityPolicy policy, std::vector<int> cpuList = {}) noexcept;
+        // 预留给其他线程（如主线程）的CPU，不分配给IO线程
+        void reserveCpu(int cpu) noexcept { this->mReservedCpus_.push_back(cpu); }
+        ComputePoolStats computePoolStats() const noexcept;
+        // 各IoService待恢复投递队列的当前深度之和
+        std::size_t postedQueueDepth() const noexcept;
+        // 汇总各IoService投递任务的等待延迟
+        LatencyHistogram::Snapshot postLatency() const noexcept;
+        // 各IoService的计数之和
+        MetricsSnapshot metrics() const noexcept;
+        void setStageSampling(std::uint32_t every) noexcept;
+        StageHistograms::Snapshot stageLatency() const noexcept;
+        void resetStageLatency() noexcept;
+        // 经ioService(i).post()可在指定IO线程中执行任务
+        std::size_t size() const noexcept;
+        IoService& ioService(std::size_t index) noexcept;
 
     private:
-        std::size_t mNextIoServiceIdx_;
+        PlacementPicker mPicker_;
+        std::vector<IoServiceLoad> mLoads_;
+        AffinityPolicy mAffinity_;
+        std::vector<int> mAffinityCpus_;
+        std::vector<int> mReservedCpus_;
         std::vector<IoService> mIoServices_;
         std::vector<std::jthread> mThreads_;
+        std::unique_ptr<ComputePool> mComputePool_;     // 析构函数中在IO线程退出后、IoService销毁前显式停止
 
         IoService& nextIoService();
     };
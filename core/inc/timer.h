@@ -1,49 +1,38 @@
 #pragma once
 #include <chrono>
 #include <functional>
-#include <set>
-#include <mutex>
+#include "timing_wheel.h"
 
 namespace blitz
 {
     class Connection;
 
+    // 在连接所属的IO线程中调用，可直接访问连接，conn->expiredTimeout()给出到期的超时类型；
+    // 回调中调用conn->close()即关闭连接，在途读写随之在内核中取消，否则该超时从现在起重新计时
     using TimeoutCallback = std::function<void(Connection* conn)>;
 
+    // 连接超时定时器，由所属IoService独占并在其线程中驱动，无需加锁。
+    // 读写完成只刷新连接上的时间戳，节点到期时若基准已后移则按剩余时间重排（惰性重排），
+    // 因此活跃连接每个超时周期至多重排一次
     class Timer
     {
     public:
-        void tick() noexcept;
+        // now为调用方在本轮事件循环中缓存的时间，同一轮内的所有检查共用
+        void tick(std::chrono::steady_clock::time_point now) noexcept;
+        // timeoutMs为空闲超时：无任何读写完成的时长
         void registTimeoutCallback(TimeoutCallback cb, std::chrono::milliseconds timeoutMs) noexcept;
-        void add(Connection* conn) noexcept;
+        // 读/写超时：有在途读/写且该方向无完成的时长；0表示不检查
+        void setIoTimeouts(std::chrono::milliseconds readMs, std::chrono::milliseconds writeMs) noexcept;
+        // 定时器节点嵌入在连接中，添加与移除均为O(1)；沿用连接上已有的基准时间（如迁入的连接）
+        void add(Connection* conn, std::chrono::steady_clock::time_point now) noexcept;
         void remove(Connection* conn) noexcept;
-
-    private:
-        class TimerInfo
-        {
-        public:
-            TimerInfo(Connection* conn, std::chrono::milliseconds timeout)
-             : conn_{conn}, time_{std::chrono::steady_clock::now() + timeout} {}
-
-            bool expired() const noexcept { return std::chrono::steady_clock::now() >= time_; }
-            Connection* connection() const noexcept { return this->conn_; }
-
-            bool operator<(const TimerInfo& rhs) const { return time_ < rhs.time_; }
-            bool operator<=(const TimerInfo& rhs) const { return time_ <= rhs.time_; }
-            bool operator>(const TimerInfo& rhs) const { return time_ > rhs.time_; }
-            bool operator>=(const TimerInfo& rhs) const { return time_ >= rhs.time_; }
-            bool operator==(const TimerInfo& rhs) const { return conn_ == rhs.conn_; }
-            bool operator!=(const TimerInfo& rhs) const { return conn_ != rhs.conn_; }
-
-        private:
-            mutable Connection* conn_;
-            std::chrono::time_point<std::chrono::steady_clock> time_;
-        };
+        bool empty() const noexcept { return 0 == this->mWheel_.size(); }
 
     private:
         TimeoutCallback mCb_;
-        std::chrono::milliseconds mTimeoutMs_;
-        std::set<TimerInfo> mTimeHeap_;
-        mutable std::mutex mMutex_;
+        std::chrono::milliseconds mTimeouts_[3]{};     // 按TimeoutKind下标
+        TimingWheel mWheel_;
+
+        void onExpire(detail::ConnectionTimerNode* node, std::chrono::steady_clock::time_point now);
     };
 }   // namespace blitz
@@ -0,0 +1,61 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "event_queue.h"
+#include "inline_function.h"
+
+namespace blitz
+{
+    // 定时回调在所属IoService线程中执行；捕获内联存放，超出容量时编译失败
+    using TimerCallback = detail::InlineFunction<void(), 48>;
+
+    // runAfter/runEvery返回的句柄，槽位复用后旧句柄自动失效
+    struct TimerId
+    {
+        std::uint32_t slot = static_cast<std::uint32_t>(-1);
+        std::uint32_t generation = 0;
+
+        bool valid() const noexcept { return static_cast<std::uint32_t>(-1) != this->slot; }
+    };
+
+    namespace detail
+    {
+        // 一个定时器对应一个io_uring超时操作，事件地址即user_data；槽位在超时操作完成（到期或被取消）后才回收
+        struct TimerEntry : TimeoutEvent
+        {
+            TimerEntry() { this->setEvent(EventType::TIMER); }
+
+            TimerCallback cb;
+            std::chrono::steady_clock::time_point deadline{};
+            std::chrono::milliseconds interval{0};      // 0为一次性定时器
+            std::uint32_t slot = 0;
+            std::uint32_t generation = 0;
+            std::uint32_t nextFree = static_cast<std::uint32_t>(-1);
+            bool active = false;        // 已安排且未取消
+            bool inflight = false;      // 超时操作已提交、完成事件尚未取回
+        };
+
+        // 每个IoService一个的定时器槽位表：条目地址稳定，回收后放入空闲链表复用，稳态下不分配内存
+        class TimerSlab
+        {
+        public:
+            TimerSlab() = default;
+            TimerSlab(const TimerSlab&) = delete;
+            TimerSlab& operator=(const TimerSlab&) = delete;
+
+            TimerEntry* acquire();
+            // 代数加一使旧句柄失效，并析构回调捕获的对象
+            void release(TimerEntry* entry) noexcept;
+            // 句柄已失效时返回nullptr
+            TimerEntry* find(TimerId id) noexcept;
+            std::size_t size() const noexcept { return this->mSize_; }
+
+        private:
+            std::deque<TimerEntry> mEntries_;
+            std::uint32_t mFreeHead_ = static_cast<std::uint32_t>(-1);
+            std::size_t mSize_ = 0;
+        };
+    }   // namespace detail
+}   // namespace blitz
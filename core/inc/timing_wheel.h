@@ -0,0 +1,113 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace blitz
+{
+    class Connection;
+
+    // 连接的超时类型：读、写分别在有在途操作且长时间无进展时到期，空闲在无任何读写完成时到期
+    enum class TimeoutKind : std::uint8_t
+    {
+        READ = 0,
+        WRITE,
+        IDLE,
+    };
+
+    namespace detail
+    {
+        // 定时器节点，嵌入在持有者对象中，取消时直接从所在槽位摘除而无需查找
+        struct TimerNode
+        {
+            TimerNode* prev = nullptr;
+            TimerNode* next = nullptr;
+            std::uint64_t expire = 0;       // 到期刻度（毫秒）
+
+            bool linked() const noexcept { return nullptr != this->prev; }
+        };
+
+        // 连接超时定时器，到期时由节点取回所属连接
+        struct ConnectionTimerNode : TimerNode
+        {
+            Connection* conn = nullptr;
+            TimeoutKind kind = TimeoutKind::IDLE;
+            // 最近一次读/写完成的时刻，完成时只更新该时刻而不重排节点，到期时再据此判断是否真正超时
+            std::chrono::steady_clock::time_point last{};
+        };
+    }   // namespace detail
+
+    // 分层时间轮：4层、每层256个槽位，刻度1ms，可表示约49天内的到期时间，插入与取消均为O(1)；
+    // 低层转完一圈时将上一层对应槽位中的节点按剩余时间重新分配到低层。非线程安全
+    class TimingWheel
+    {
+    public:
+        explicit TimingWheel(std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now()) noexcept;
+        TimingWheel(const TimingWheel&) = delete;
+        TimingWheel& operator=(const TimingWheel&) = delete;
+
+        // 节点已在轮中时先取消再重新安排；now为调用方缓存的当前时间
+        void schedule(detail::TimerNode* node, std::chrono::milliseconds delay,
+                      std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now()) noexcept;
+        void cancel(detail::TimerNode* node) noexcept;
+        std::size_t size() const noexcept { return this->mSize_; }
+
+        // 推进到now，依次对到期节点调用onExpire(TimerNode*)；回调中可安排或取消任意节点
+        template<typename F>
+        void advance(std::chrono::steady_clock::time_point now, F&& onExpire);
+
+    private:
+        constexpr static std::size_t LevelBits = 8;
+        constexpr static std::size_t LevelNum = 4;
+        constexpr static std::size_t SlotNum = 1 << LevelBits;
+        constexpr static std::uint64_t SlotMask = SlotNum - 1;
+        constexpr static std::uint64_t MaxDelta = (std::uint64_t{1} << (LevelBits * LevelNum)) - 1;
+
+        std::chrono::steady_clock::time_point mStart_;
+        std::uint64_t mNow_;            // 已处理到的刻度
+        std::size_t mSize_;
+        detail::TimerNode mSlots_[LevelNum][SlotNum];      // 各槽位为带哨兵的循环双向链表
+
+        std::uint64_t toTick(std::chrono::steady_clock::time_point tp) const noexcept;
+        void place(detail::TimerNode* node) noexcept;
+        void cascade(std::size_t level, std::uint64_t tick) noexcept;
+        static void Unlink(detail::TimerNode* node) noexcept;
+        static void PushBack(detail::TimerNode* head, detail::TimerNode* node) noexcept;
+        // 将head链表整体移入空链表to
+        static void Splice(detail::TimerNode* head, detail::TimerNode* to) noexcept;
+    };
+
+    template<typename F>
+    void TimingWheel::advance(std::chrono::steady_clock::time_point now, F&& onExpire)
+    {
+        std::uint64_t target = this->toTick(now);
+        while (this->mNow_ < target)
+        {
+            if (0 == this->mSize_)
+            {
+                // 轮空时直接跳到目标刻度
+                this->mNow_ = target;
+                break;
+            }
+            std::uint64_t tick = this->mNow_ + 1;
+            // 自高层向低层依次下放，保证本刻度到期的节点都落入第0层对应槽位
+            for (std::size_t level = LevelNum - 1; level > 0; --level)
+            {
+                if (0 == (tick & ((std::uint64_t{1} << (LevelBits * level)) - 1)))
+                {
+                    this->cascade(level, tick);
+                }
+            }
+            this->mNow_ = tick;
+            detail::TimerNode expired;
+            Splice(&this->mSlots_[0][tick & SlotMask], &expired);
+            while (expired.next != &expired)
+            {
+                auto* node = expired.next;
+                Unlink(node);
+                --this->mSize_;
+                onExpire(node);
+            }
+        }
+    }
+}   // namespace blitz
@@ -0,0 +1,147 @@
+#include "affinity.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <set>
+#include <string>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace blitz
+{
+    // 解析/sys中"0-3,8,10-11"形式的CPU列表
+    static std::vector<int> ParseCpuList(const std::string& text)
+    {
+        std::vector<int> cpus;
+        std::size_t pos = 0;
+        while (pos < text.size())
+        {
+            std::size_t end = text.find(',', pos);
+            if (end == std::string::npos)   end = text.size();
+            std::string item = text.substr(pos, end - pos);
+            pos = end + 1;
+            if (item.empty() || !std::isdigit(static_cast<unsigned char>(item[0])))  continue;
+            std::size_t dash = item.find('-');
+            int lo = std::stoi(item.substr(0, dash));
+            int hi = (dash == std::string::npos) ? lo : std::stoi(item.substr(dash + 1));
+            for (int c = lo; c <= hi; ++c)
+            {
+                cpus.push_back(c);
+            }
+        }
+        return cpus;
+    }
+
+    static std::vector<int> ReadCpuList(const std::string& path)
+    {
+        std::ifstream in{path};
+        std::string text;
+        std::getline(in, text);
+        return ParseCpuList(text);
+    }
+
+    static std::vector<int> AllowedCpus()
+    {
+        std::vector<int> cpus = ReadCpuList("/sys/devices/system/cpu/online");
+#ifdef __linux__
+        // 容器等环境下进程可用的CPU可能少于在线CPU
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (0 == ::sched_getaffinity(0, sizeof(set), &set))
+        {
+            std::erase_if(cpus, [&set](int c)->bool { return !CPU_ISSET(c, &set); });
+        }
+#endif
+        return cpus;
+    }
+
+    CpuTopology CpuTopology::Detect()
+    {
+        CpuTopology topo;
+        topo.cpus = AllowedCpus();
+        std::set<int> allowed{topo.cpus.begin(), topo.cpus.end()};
+        auto keepAllowed = [&allowed](std::vector<int> cpus)->std::vector<int>
+        {
+            std::erase_if(cpus, [&allowed](int c)->bool { return !allowed.count(c); });
+            return cpus;
+        };
+
+        std::set<std::vector<int>> cores;
+        for (int c : topo.cpus)
+        {
+            auto siblings = keepAllowed(ReadCpuList("/sys/devices/system/cpu/cpu" + std::to_string(c) + "/topology/thread_siblings_list"));
+            if (siblings.empty())   siblings.push_back(c);
+            cores.insert(siblings);
+        }
+        topo.cores.assign(cores.begin(), cores.end());
+
+        for (int n : ReadCpuList("/sys/devices/system/node/online"))
+        {
+            auto cpus = keepAllowed(ReadCpuList("/sys/devices/system/node/node" + std::to_string(n) + "/cpulist"));
+            if (!cpus.empty())  topo.nodes.push_back(std::move(cpus));
+        }
+        if (topo.nodes.empty() && !topo.cpus.empty())
+        {
+            // 无NUMA信息时视为单节点
+            topo.nodes.push_back(topo.cpus);
+        }
+        return topo;
+    }
+
+    std::vector<std::vector<int>> PlanAffinity(AffinityPolicy policy, std::span<const int> cpuList, std::size_t threadNum,
+                                               std::span<const int> excluded, const CpuTopology& topo)
+    {
+        std::vector<std::vector<int>> plan(threadNum);
+        auto isExcluded = [excluded](int c)->bool { return std::find(excluded.begin(), excluded.end(), c) != excluded.end(); };
+        std::vector<std::vector<int>> groups;
+        switch (policy)
+        {
+        case AffinityPolicy::CPU_LIST:
+            for (int c : cpuList)
+            {
+                if (!isExcluded(c)) groups.push_back({c});
+            }
+            break;
+        case AffinityPolicy::PHYSICAL_CORES:
+            // 每个物理核只取一个逻辑CPU；主线程所在的核整核让出
+            for (auto& core : topo.cores)
+            {
+                if (std::none_of(core.begin(), core.end(), isExcluded))   groups.push_back({core.front()});
+            }
+            break;
+        case AffinityPolicy::NUMA_LOCAL:
+            for (auto node : topo.nodes)
+            {
+                std::erase_if(node, isExcluded);
+                if (!node.empty())  groups.push_back(std::move(node));
+            }
+            break;
+        default:
+            break;
+        }
+        if (groups.empty()) return plan;
+        for (std::size_t i = 0; i < threadNum; ++i)
+        {
+            plan[i] = groups[i % groups.size()];
+        }
+        return plan;
+    }
+
+    bool PinCurrentThread(std::span<const int> cpus)
+    {
+        if (cpus.empty())   return false;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int c : cpus)
+        {
+            CPU_SET(c, &set);
+        }
+        return 0 == ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+#else
+        return false;
+#endif
+    }
+}   // namespace blitz
@@ -2,22 +2,109 @@
 #include <algorithm>
 #include <iostream>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BLITZ_X86_SIMD
+#endif
+
 namespace blitz
 {
     constexpr static std::uint16_t OneChunkSize = 1024;
-    constexpr static std::uint8_t InitChunkListCapacity = 2;
+    constexpr static std::uint8_t InitChunkListCapacity = 3;
+    // 每个线程的chunk池最多缓存的空闲chunk数
+    constexpr static std::size_t MaxPooledChunkNum = 1024;
+
+    static std::atomic<std::size_t> sAllocatedChunkBytes{0};
+    static std::atomic<std::size_t> sPooledChunkBytes{0};
+
+    // 在[first, last)中查找字节ch，返回首个匹配位置；未找到返回last
+    static const char* FindByteScalar(const char* first, const char* last, char ch)
+    {
+        for (; first != last; ++first)
+        {
+            if (*first == ch)   return first;
+        }
+        return last;
+    }
+
+#ifdef BLITZ_X86_SIMD
+    static const char* FindByteSse2(const char* first, const char* last, char ch)
+    {
+        const __m128i needle = _mm_set1_epi8(ch);
+        for (; last - first >= 16; first += 16)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            if (int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)); mask)
+            {
+                return first + __builtin_ctz(mask);
+            }
+        }
+        return FindByteScalar(first, last, ch);
+    }
+
+    __attribute__((target("avx2")))
+    static const char* FindByteAvx2(const char* first, const char* last, char ch)
+    {
+        const __m256i needle = _mm256_set1_epi8(ch);
+        for (; last - first >= 32; first += 32)
+        {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first));
+            if (unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)); mask)
+            {
+                return first + __builtin_ctz(mask);
+            }
+        }
+        return FindByteSse2(first, last, ch);
+    }
+#endif
+
+    using FindByteFunc = const char* (*)(const char*, const char*, char);
+
+    // 运行时按CPU能力选择实现：AVX2 > SSE2 > 标量
+    static FindByteFunc SelectFindByte()
+    {
+#ifdef BLITZ_X86_SIMD
+        if (__builtin_cpu_supports("avx2"))  return &FindByteAvx2;
+        return &FindByteSse2;
+#else
+        return &FindByteScalar;
+#endif
+    }
+
+    static const char* FindByte(const char* first, const char* last, char ch)
+    {
+        // 首次调用时选择，不依赖命名空间作用域静态对象的初始化顺序
+        static const FindByteFunc impl = SelectFindByte();
+        return impl(first, last, ch);
+    }
 
     namespace detail
     {
         BufferChunk::BufferChunk()
+            : BufferChunk(OneChunkSize)
+        {
+
+        }
+
+        BufferChunk::BufferChunk(std::size_t capacity)
             : refCnt(0)
             , readIdx(0), writeIdx(0)
-            , next(nullptr)
+            , next(nullptr), ref(nullptr), fileFd(-1)
         {
-            this->buf.resize(OneChunkSize);
+            this->buf.resize(capacity);
             this->buf.shrink_to_fit();
         }
 
+        char* BufferChunk::data()
+        {
+            return this->ref ? this->ref->buf.data() : this->buf.data();
+        }
+
+        const char* BufferChunk::data() const
+        {
+            return this->ref ? this->ref->buf.data() : this->buf.data();
+        }
+
         std::size_t BufferChunk::readableSize() const
         {
             return this->writeIdx - this->readIdx;
@@ -25,20 +112,22 @@ namespace blitz
 
         std::size_t BufferChunk::writeableSize() const
         {
-            return this->buf.size() - this->writeIdx;
+            // 共享chunk的引用与文件段只读
+            return (this->ref || this->isFile()) ? 0 : this->buf.size() - this->writeIdx;
         }
 
         std::size_t BufferChunk::readFromChunk(std::span<char> data)
         {
             std::size_t readableBytes = this->readableSize();
             std::size_t readBytes = (readableBytes > data.size()) ? data.size() : readableBytes;
-            std::copy(&this->buf[this->readIdx], &this->buf[this->readIdx + readBytes], data.begin());
+            std::copy(this->data() + this->readIdx, this->data() + this->readIdx + readBytes, data.begin());
             this->readIdx += readBytes;
             return readBytes;
         }
 
         std::size_t BufferChunk::writeIntoChunk(std::span<const char> data)
         {
+            if (this->ref || this->isFile())  return 0;
             // 若当前空间不足以容纳数据，则尝试对已有数据进行移动
             if (this->writeableSize() < data.size())
             {
@@ -56,7 +145,7 @@ namespace blitz
 
         void BufferChunk::moveInside()
         {
-            if (0 == this->readIdx)  return;
+            if (this->ref || this->isFile() || 0 == this->readIdx)  return;
             if (this->readIdx == this->writeIdx)
             {
                 this->readIdx = this->writeIdx = 0;
@@ -85,26 +174,144 @@ namespace blitz
             this->readIdx = 0;
             this->writeIdx = validBytes;
         }
+
+        // 线程私有的空闲chunk池：chunk在哪个线程归还就缓存在哪个线程
+        class ChunkPool
+        {
+        public:
+            ChunkPool() : mFreeList_{nullptr}, mSize_{0} {}
+            ChunkPool(const ChunkPool&) = delete;
+            ChunkPool& operator=(const ChunkPool&) = delete;
+
+            ~ChunkPool()
+            {
+                while (this->mFreeList_)
+                {
+                    auto* chunk = this->mFreeList_;
+                    this->mFreeList_ = chunk->next;
+                    this->destroy(chunk);
+                }
+            }
+
+            static ChunkPool& local()
+            {
+                thread_local ChunkPool pool;
+                return pool;
+            }
+
+            BufferChunk* acquire()
+            {
+                if (!this->mFreeList_)
+                {
+                    sAllocatedChunkBytes.fetch_add(OneChunkSize, std::memory_order_relaxed);
+                    return new BufferChunk();
+                }
+                auto* chunk = this->mFreeList_;
+                this->mFreeList_ = chunk->next;
+                chunk->next = nullptr;
+                --this->mSize_;
+                sPooledChunkBytes.fetch_sub(OneChunkSize, std::memory_order_relaxed);
+                return chunk;
+            }
+
+            void release(BufferChunk* chunk)
+            {
+                if (this->mSize_ >= MaxPooledChunkNum)
+                {
+                    this->destroy(chunk);
+                    return;
+                }
+                chunk->readIdx = chunk->writeIdx = 0;
+                chunk->next = this->mFreeList_;
+                this->mFreeList_ = chunk;
+                ++this->mSize_;
+                sPooledChunkBytes.fetch_add(OneChunkSize, std::memory_order_relaxed);
+            }
+
+        private:
+            BufferChunk* mFreeList_;
+            std::size_t mSize_;
+
+            void destroy(BufferChunk* chunk)
+            {
+                sAllocatedChunkBytes.fetch_sub(OneChunkSize, std::memory_order_relaxed);
+                delete chunk;
+            }
+        };
+
+        void ReleaseSharedChunk(BufferChunk* chunk)
+        {
+            if (1 == chunk->refCnt.fetch_sub(1, std::memory_order_acq_rel))
+            {
+                delete chunk;
+            }
+        }
     }   // namespace detail
 
-    ChainBuffer::ChainBuffer()
-        : mListSize_{0}
-        , mListCapacity_{InitChunkListCapacity}
-        , mChunkListHead_{new detail::BufferChunk()}
-        , mReadableAreaIovecs_{nullptr}, mWriteableAreaIovecs_{nullptr}
+    SharedBuffer::SharedBuffer(std::span<const char> data)
+        : mChunk_{new detail::BufferChunk(data.size())}
     {
-        this->mChunkListLast_ = this->mChunkListHead_;
-        this->mChunkListLastWithData_ = this->mChunkListHead_;
-        this->expand(this->mListCapacity_);
+        std::copy(data.begin(), data.end(), this->mChunk_->buf.begin());
+        this->mChunk_->writeIdx = data.size();
+        this->mChunk_->refCnt.store(1, std::memory_order_relaxed);
     }
 
-    ChainBuffer::ChainBuffer(ChainBuffer&& rhs)
-        : mListSize_{0}
-        , mListCapacity_{0}
+    SharedBuffer::SharedBuffer(const SharedBuffer& rhs)
+        : mChunk_{rhs.mChunk_}
+    {
+        this->mChunk_->refCnt.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    SharedBuffer& SharedBuffer::operator=(const SharedBuffer& rhs)
+    {
+        if (this != &rhs)
+        {
+            rhs.mChunk_->refCnt.fetch_add(1, std::memory_order_relaxed);
+            detail::ReleaseSharedChunk(this->mChunk_);
+            this->mChunk_ = rhs.mChunk_;
+        }
+        return *this;
+    }
+
+    SharedBuffer::~SharedBuffer()
+    {
+        detail::ReleaseSharedChunk(this->mChunk_);
+    }
+
+    std::size_t SharedBuffer::size() const
+    {
+        return this->mChunk_->writeIdx;
+    }
+
+    std::span<const char> ChainBuffer::ReadableSegments::Iterator::operator*() const
+    {
+        return {this->mChunk_->data() + this->mChunk_->readIdx, this->mChunk_->readableSize()};
+    }
+
+    ChainBuffer::ReadableSegments::Iterator& ChainBuffer::ReadableSegments::Iterator::operator++()
+    {
+        // 跳过空chunk，保证解引用得到的视图均非空
+        do
+        {
+            this->mChunk_ = this->mChunk_->next;
+        } while (this->mChunk_ != this->mEnd_ && 0 == this->mChunk_->readableSize());
+        return *this;
+    }
+
+    ChainBuffer::ChainBuffer()
+        : mListCapacity_{0}
+        , mReadableBytes_{0}
+        , mFileChunkNum_{0}
         , mChunkListHead_{nullptr}
         , mChunkListLast_{nullptr}
         , mChunkListLastWithData_{nullptr}
         , mReadableAreaIovecs_{nullptr}, mWriteableAreaIovecs_{nullptr}
+    {
+        // chunk延迟到首次写入或首次提交内核读时才分配
+    }
+
+    ChainBuffer::ChainBuffer(ChainBuffer&& rhs)
+        : ChainBuffer()
     {
         *this = std::move(rhs);
     }
@@ -113,32 +320,60 @@ namespace blitz
     {
         if (this != &rhs)
         {
-            this->mListSize_ = rhs.mListSize_;
+            this->releaseChunks();
             this->mListCapacity_= rhs.mListCapacity_;
+            this->mReadableBytes_ = rhs.mReadableBytes_;
+            this->mFileChunkNum_ = rhs.mFileChunkNum_;
             this->mChunkListHead_= rhs.mChunkListHead_;
             this->mChunkListLast_= rhs.mChunkListLast_;
             this->mChunkListLastWithData_= rhs.mChunkListLastWithData_;
             this->mReadableAreaIovecs_ = rhs.mReadableAreaIovecs_;
             this->mWriteableAreaIovecs_ = rhs.mWriteableAreaIovecs_;
-            rhs.mListSize_ = 0;
-            rhs.mListCapacity_ = InitChunkListCapacity;
-            rhs.mChunkListHead_ = new detail::BufferChunk();
+            rhs.mListCapacity_ = 0;
+            rhs.mReadableBytes_ = 0;
+            rhs.mFileChunkNum_ = 0;
+            rhs.mChunkListHead_ = rhs.mChunkListLast_ = rhs.mChunkListLastWithData_ = nullptr;
             rhs.mReadableAreaIovecs_ = nullptr;
             rhs.mWriteableAreaIovecs_ = nullptr;
-            rhs.expand(rhs.mListCapacity_);
         }
         return *this;
     }
 
     ChainBuffer::~ChainBuffer()
+    {
+        this->releaseChunks();
+    }
+
+    void ChainBuffer::releaseNode(detail::BufferChunk* node)
+    {
+        if (node->ref)
+        {
+            detail::ReleaseSharedChunk(node->ref);
+            delete node;
+        }
+        else if (node->isFile())
+        {
+            --this->mFileChunkNum_;
+            delete node;
+        }
+        else
+        {
+            --this->mListCapacity_;
+            detail::ChunkPool::local().release(node);
+        }
+    }
+
+    void ChainBuffer::releaseChunks()
     {
         auto* tmp = this->mChunkListHead_;
         while (tmp)
         {
             auto* node = tmp;
             tmp = tmp->next;
-            delete node;
+            this->releaseNode(node);
         }
+        this->mChunkListHead_ = this->mChunkListLast_ = this->mChunkListLastWithData_ = nullptr;
+        this->mReadableBytes_ = 0;
         if (this->mReadableAreaIovecs_)
         {
             this->destroyReadableIovecs();
@@ -149,87 +384,317 @@ namespace blitz
         }
     }
 
-    std::size_t ChainBuffer::readFromBuffer(std::span<char> data)
+    std::size_t ChainBuffer::capacityBytes() const
     {
-        std::size_t n, transferredBytes = 0;
-        auto* chunk = this->mChunkListHead_;
-        detail::BufferChunk* lastChunk = nullptr;
-        // 读取
-        while (true)
+        return this->mListCapacity_ * OneChunkSize;
+    }
+
+    void ChainBuffer::shrink(std::size_t keepBytes)
+    {
+        if (!this->mChunkListHead_) return;
+        std::size_t keepChunkNum = (keepBytes + OneChunkSize - 1) / OneChunkSize;
+        if (0 == this->mReadableBytes_ && 0 == keepChunkNum)
         {
-            n = chunk->readFromChunk(std::span<char>{data.data() + transferredBytes, data.size() - transferredBytes});
-            transferredBytes += n;
-            if ((transferredBytes == data.size()) || (0 == n) || (chunk == this->mChunkListLastWithData_)) 
-            {
-                if (0 == chunk->readableSize())
-                {
-                    lastChunk = chunk;
-                }
-                break;
-            }
-            lastChunk = chunk;
-            chunk = chunk->next;
+            this->releaseChunks();
+            return;
         }
-        // 更新chunk链表：将无数据的chunk挂接在链表尾部
-        if (lastChunk)
+        // 有数据的chunk必须保留，仅归还其后的空chunk
+        std::size_t usedChunkNum = 0;
+        for (auto* chunk = this->mChunkListHead_; chunk != this->mChunkListLastWithData_->next; chunk = chunk->next)
         {
-            auto* tmp = chunk->next;
-            chunk->next = nullptr;
-            this->mChunkListLast_->next = this->mChunkListHead_;
-            this->mChunkListHead_ = tmp;
-            this->mChunkListLast_ = chunk;
+            if (!chunk->ref && !chunk->isFile())    ++usedChunkNum;
+        }
+        auto* last = this->mChunkListLastWithData_;
+        for (std::size_t n = usedChunkNum; n < keepChunkNum && last->next; ++n)
+        {
+            last = last->next;
+        }
+        auto* tmp = last->next;
+        last->next = nullptr;
+        this->mChunkListLast_ = last;
+        while (tmp)
+        {
+            auto* node = tmp;
+            tmp = tmp->next;
+            this->releaseNode(node);
         }
-        return transferredBytes;
+    }
+
+    std::size_t ChainBuffer::totalAllocatedBytes()
+    {
+        return sAllocatedChunkBytes.load(std::memory_order_relaxed);
+    }
+
+    std::size_t ChainBuffer::totalPooledBytes()
+    {
+        return sPooledChunkBytes.load(std::memory_order_relaxed);
+    }
+
+    std::size_t ChainBuffer::readFromBuffer(std::span<char> data)
+    {
+        std::size_t transferredBytes = 0;
+        for (auto segment : this->readableSegments())
+        {
+            if (transferredBytes == data.size())    break;
+            std::size_t n = std::min(segment.size(), data.size() - transferredBytes);
+            std::copy(segment.begin(), segment.begin() + n, data.begin() + transferredBytes);
+            transferredBytes += n;
+        }
+        return this->consume(transferredBytes);
     }
 
     std::size_t ChainBuffer::writeIntoBuffer(std::span<const char> data)
     {
         std::size_t n, transferredBytes = 0;
+        if (data.empty())   return 0;
+        if (!this->mChunkListHead_)
+        {
+            this->expand((data.size() + OneChunkSize - 1) / OneChunkSize);
+        }
         auto* chunk = this->mChunkListLastWithData_;
-        // 写入数据
+        // 写入数据：从最后一个有数据的chunk开始向后填充
         while (transferredBytes < data.size())
         {
             n = chunk->writeIntoChunk(std::span<const char>{data.data() + transferredBytes, data.size() - transferredBytes});
             transferredBytes += n;
+            if (n > 0)
+            {
+                this->mChunkListLastWithData_ = chunk;
+            }
+            if (transferredBytes == data.size())    break;
             if (chunk == this->mChunkListLast_)
             {
-                // 扩容：首先计算还需要写入多少字节，然后计算当前块填满后还需要多少个块
+                // 扩容：按剩余字节数计算还需要多少个块
                 std::size_t restBytes = data.size() - transferredBytes;
-                std::uint8_t chunkNum = (restBytes - chunk->writeableSize()) / OneChunkSize + 1;
-                this->expand(chunkNum);
-            } 
-            this->mChunkListLastWithData_ = chunk;
+                this->expand((restBytes + OneChunkSize - 1) / OneChunkSize);
+            }
             chunk = chunk->next;
         }
+        this->mReadableBytes_ += transferredBytes;
         return transferredBytes;
     }
 
-    void ChainBuffer::expand(std::uint8_t chunkNum)
+    std::size_t ChainBuffer::appendShared(const SharedBuffer& data)
+    {
+        if (0 == data.size())   return 0;
+        auto* node = new detail::BufferChunk(0);
+        node->ref = data.mChunk_;
+        node->ref->refCnt.fetch_add(1, std::memory_order_relaxed);
+        node->writeIdx = data.size();
+        this->appendNode(node);
+        return node->writeIdx;
+    }
+
+    std::size_t ChainBuffer::appendFile(int fd, std::size_t offset, std::size_t len)
+    {
+        if (fd < 0 || 0 == len)   return 0;
+        auto* node = new detail::BufferChunk(0);
+        node->fileFd = fd;
+        node->readIdx = offset;
+        node->writeIdx = offset + len;
+        this->appendNode(node);
+        ++this->mFileChunkNum_;
+        return len;
+    }
+
+    void ChainBuffer::appendNode(detail::BufferChunk* node)
+    {
+        if (!this->mChunkListHead_)
+        {
+            this->mChunkListHead_ = this->mChunkListLast_ = node;
+        }
+        else if (0 == this->mReadableBytes_)
+        {
+            // 缓冲区为空时直接作为头节点，保证有数据时头节点必有可读数据
+            node->next = this->mChunkListHead_;
+            this->mChunkListHead_ = node;
+        }
+        else
+        {
+            // 在最后一个有数据的chunk之后插入，后续写入会落在其后的空chunk中
+            node->next = this->mChunkListLastWithData_->next;
+            this->mChunkListLastWithData_->next = node;
+            if (this->mChunkListLast_ == this->mChunkListLastWithData_)
+            {
+                this->mChunkListLast_ = node;
+            }
+        }
+        this->mChunkListLastWithData_ = node;
+        this->mReadableBytes_ += node->readableSize();
+    }
+
+    bool ChainBuffer::frontFileRegion(FileRegion& region) const
+    {
+        const auto* chunk = this->mChunkListHead_;
+        if (0 == this->mReadableBytes_ || !chunk->isFile())  return false;
+        region.fd = chunk->fileFd;
+        region.offset = chunk->readIdx;
+        region.len = chunk->readableSize();
+        return true;
+    }
+
+    const detail::BufferChunk* ChainBuffer::memoryAreaEnd() const
+    {
+        if (!this->mChunkListLastWithData_) return nullptr;
+        const auto* end = this->mChunkListLastWithData_->next;
+        if (0 == this->mFileChunkNum_)  return end;
+        for (const auto* chunk = this->mChunkListHead_; chunk != end; chunk = chunk->next)
+        {
+            if (chunk->isFile())    return chunk;
+        }
+        return end;
+    }
+
+    std::size_t ChainBuffer::readableBytes() const
+    {
+        return this->mReadableBytes_;
+    }
+
+    ChainBuffer::ReadableSegments ChainBuffer::readableSegments() const
+    {
+        const auto* first = this->mChunkListHead_;
+        const auto* end = this->memoryAreaEnd();
+        while (first != end && 0 == first->readableSize())
+        {
+            first = first->next;
+        }
+        return {first, end};
+    }
+
+    std::span<const char> ChainBuffer::peek(std::size_t n) const
+    {
+        const auto* chunk = this->mChunkListHead_;
+        if (!chunk || chunk->isFile() || chunk->readableSize() < n)  return {};
+        return {chunk->data() + chunk->readIdx, n};
+    }
+
+    std::size_t ChainBuffer::consume(std::size_t n)
+    {
+        n = std::min(n, this->mReadableBytes_);
+        std::size_t restBytes = n;
+        while (restBytes > 0)
+        {
+            auto* chunk = this->mChunkListHead_;
+            std::size_t step = std::min(restBytes, chunk->readableSize());
+            chunk->readIdx += step;
+            restBytes -= step;
+            if (0 == chunk->readableSize())
+            {
+                this->recycleHeadChunk();
+            }
+        }
+        this->mReadableBytes_ -= n;
+        return n;
+    }
+
+    // 从chunk内下标idx处开始逐字节比对分隔符，分隔符可跨越chunk边界
+    static bool MatchDelimiter(const detail::BufferChunk* chunk, std::size_t idx, 
+                               const detail::BufferChunk* end, std::string_view delim)
+    {
+        for (char ch : delim)
+        {
+            while (idx == chunk->writeIdx)
+            {
+                chunk = chunk->next;
+                if (chunk == end)   return false;
+                idx = chunk->readIdx;
+            }
+            if (chunk->data()[idx] != ch)  return false;
+            ++idx;
+        }
+        return true;
+    }
+
+    std::size_t ChainBuffer::find(char ch) const
+    {
+        return this->find(std::string_view{&ch, 1});
+    }
+
+    std::size_t ChainBuffer::find(std::string_view delim) const
+    {
+        if (delim.empty())  return 0;
+        if (delim.size() > this->mReadableBytes_)   return npos;
+        std::size_t offset = 0;
+        const auto* end = this->memoryAreaEnd();
+        for (const auto* chunk = this->mChunkListHead_; chunk != end; chunk = chunk->next)
+        {
+            // 先用SIMD定位分隔符首字节的候选位置，再校验完整分隔符
+            const char* first = chunk->data() + chunk->readIdx;
+            const char* last = chunk->data() + chunk->writeIdx;
+            for (const char* pos = FindByte(first, last, delim[0]); pos != last; pos = FindByte(pos + 1, last, delim[0]))
+            {
+                if (MatchDelimiter(chunk, pos - chunk->data(), end, delim))
+                {
+                    return offset + (pos - first);
+                }
+            }
+            offset += chunk->readableSize();
+        }
+        return npos;
+    }
+
+    void ChainBuffer::recycleHeadChunk()
+    {
+        // 更新chunk链表：将已读空的头部chunk挂接在链表尾部
+        auto* chunk = this->mChunkListHead_;
+        if (chunk->ref || chunk->isFile())
+        {
+            // 共享chunk的引用节点与文件段读空后直接释放
+            this->mChunkListHead_ = chunk->next;
+            if (chunk == this->mChunkListLastWithData_)
+            {
+                this->mChunkListLastWithData_ = chunk->next;
+            }
+            if (chunk == this->mChunkListLast_)
+            {
+                this->mChunkListHead_ = this->mChunkListLast_ = this->mChunkListLastWithData_ = nullptr;
+            }
+            this->releaseNode(chunk);
+            return;
+        }
+        chunk->readIdx = chunk->writeIdx = 0;
+        if (chunk == this->mChunkListLastWithData_ || chunk == this->mChunkListLast_)  return;
+        this->mChunkListHead_ = chunk->next;
+        chunk->next = nullptr;
+        this->mChunkListLast_->next = chunk;
+        this->mChunkListLast_ = chunk;
+    }
+
+    void ChainBuffer::expand(std::size_t chunkNum)
     {
         if (0 == chunkNum)  return;
-        detail::BufferChunk* node = nullptr;
-        for (std::uint8_t n = 0; n < chunkNum; ++n) 
+        auto& pool = detail::ChunkPool::local();
+        for (std::size_t n = 0; n < chunkNum; ++n) 
         {
-            node = new detail::BufferChunk();
-            this->mChunkListLast_->next = node;
+            auto* node = pool.acquire();
+            if (!this->mChunkListHead_)
+            {
+                this->mChunkListHead_ = this->mChunkListLastWithData_ = node;
+            }
+            else
+            {
+                this->mChunkListLast_->next = node;
+            }
             this->mChunkListLast_ = node;
         }
-        mListCapacity_ += chunkNum;
+        this->mListCapacity_ += chunkNum;
     }
 
     std::span<const ChainBuffer::NativeIoVec> ChainBuffer::readableArea2Iovecs()
     {
 #ifdef __linux__
+        // 文件段之后的数据需等该文件段经splice发送完成后再提交
+        const auto* end = this->memoryAreaEnd();
         std::size_t i, len;
         i = len = 0;
-        for (auto* chunk = this->mChunkListHead_; chunk != this->mChunkListLastWithData_->next; chunk = chunk->next)
+        for (auto* chunk = this->mChunkListHead_; chunk != end; chunk = chunk->next)
         {
             ++len;
         }
         this->mReadableAreaIovecs_ = new NativeIoVec[len];
-        for (auto* chunk = this->mChunkListHead_; chunk != this->mChunkListLastWithData_->next; chunk = chunk->next)
+        for (auto* chunk = this->mChunkListHead_; chunk != end; chunk = chunk->next)
         {
-            this->mReadableAreaIovecs_[i].iov_base = &chunk->buf[chunk->readIdx];
+            this->mReadableAreaIovecs_[i].iov_base = chunk->data() + chunk->readIdx;
             this->mReadableAreaIovecs_[i].iov_len = chunk->writeIdx - chunk->readIdx;
             ++i;
         }
@@ -239,20 +704,46 @@ namespace blitz
 #endif
     }
 
-    std::span<const ChainBuffer::NativeIoVec> ChainBuffer::writeableArea2Iovecs()
+    std::span<const ChainBuffer::NativeIoVec> ChainBuffer::writeableArea2Iovecs(std::size_t maxBytes)
     {
 #ifdef __linux__
-        std::size_t i, len;
+        // 可写区域：最后一个有数据chunk的剩余空间，以及其后的空chunk；尚未分配时在此分配
+        if (npos == maxBytes)
+        {
+            if (!this->mChunkListHead_)
+            {
+                this->expand(InitChunkListCapacity);
+            }
+        }
+        else
+        {
+            // 可写空间不足maxBytes时扩容，多出的部分不提交给内核
+            std::size_t writeableBytes = 0;
+            for (auto* chunk = this->mChunkListLastWithData_; chunk; chunk = chunk->next)
+            {
+                writeableBytes += chunk->writeableSize();
+            }
+            if (writeableBytes < maxBytes)
+            {
+                this->expand((maxBytes - writeableBytes + OneChunkSize - 1) / OneChunkSize);
+            }
+        }
+        std::size_t i, len, restBytes;
         i = len = 0;
-        for (auto* chunk = this->mChunkListHead_; chunk; chunk = chunk->next)
+        restBytes = maxBytes;
+        for (auto* chunk = this->mChunkListLastWithData_; chunk && restBytes > 0; chunk = chunk->next)
         {
+            restBytes -= std::min(restBytes, chunk->writeableSize());
             ++len;
         }
         this->mWriteableAreaIovecs_ = new NativeIoVec[len];
-        for (auto* chunk = this->mChunkListHead_; chunk; chunk = chunk->next)
+        restBytes = maxBytes;
+        for (auto* chunk = this->mChunkListLastWithData_; i < len; chunk = chunk->next)
         {
-            this->mWriteableAreaIovecs_[i].iov_base = &chunk->buf[chunk->writeIdx];
-            this->mWriteableAreaIovecs_[i].iov_len = chunk->buf.size() - chunk->writeIdx;
+            std::size_t n = std::min(restBytes, chunk->writeableSize());
+            this->mWriteableAreaIovecs_[i].iov_base = chunk->data() + chunk->writeIdx;
+            this->mWriteableAreaIovecs_[i].iov_len = n;
+            restBytes -= n;
             ++i;
         }
         return {this->mWriteableAreaIovecs_, len};
@@ -263,24 +754,17 @@ namespace blitz
 
     void ChainBuffer::moveReadableAreaIdx(std::size_t transferredBytes)
     {
-        for (auto* chunk = this->mChunkListHead_; chunk != this->mChunkListLastWithData_->next; chunk = chunk->next)
-        {
-            std::size_t restBytes = chunk->writeIdx - chunk->readIdx;
-            if (restBytes >= transferredBytes)
-            {
-                chunk->readIdx += transferredBytes;
-                break;
-            }
-            transferredBytes -= restBytes;
-            chunk->readIdx += restBytes;
-        }
+        this->consume(transferredBytes);
     }
 
     void ChainBuffer::moveWriteableAreaIdx(std::size_t transferredBytes)
     {
-        for (auto* chunk = this->mChunkListHead_; chunk != this->mChunkListLastWithData_->next; chunk = chunk->next)
+        this->mReadableBytes_ += transferredBytes;
+        for (auto* chunk = this->mChunkListLastWithData_; chunk && transferredBytes > 0; chunk = chunk->next)
         {
-            std::size_t restBytes = chunk->buf.size() - chunk->writeIdx;
+            std::size_t restBytes = chunk->writeableSize();
+            if (0 == restBytes) continue;
+            this->mChunkListLastWithData_ = chunk;
             if (restBytes >= transferredBytes)
             {
                 chunk->writeIdx += transferredBytes;
@@ -0,0 +1,70 @@
+#include "compute_pool.h"
+
+namespace blitz
+{
+    ComputePool::ComputePool(std::size_t threadNum)
+        : mStopped_{false}, mSubmitted_{0}, mCompleted_{0}, mQueueDepth_{0}, mPeakQueueDepth_{0}
+    {
+        for (std::size_t i = 0; i < threadNum; ++i)
+        {
+            this->mThreads_.emplace_back([this]()->void { this->workerLoop(); });
+        }
+    }
+
+    ComputePool::~ComputePool()
+    {
+        {
+            std::lock_guard l{this->mMtx_};
+            this->mStopped_ = true;
+        }
+        this->mCv_.notify_all();
+        this->mThreads_.clear();
+    }
+
+    bool ComputePool::submit(Job job)
+    {
+        {
+            std::lock_guard l{this->mMtx_};
+            if (this->mStopped_)    return false;
+            this->mJobs_.push_back(std::move(job));
+            std::size_t depth = this->mJobs_.size();
+            this->mQueueDepth_.store(depth, std::memory_order_relaxed);
+            if (depth > this->mPeakQueueDepth_.load(std::memory_order_relaxed))
+            {
+                this->mPeakQueueDepth_.store(depth, std::memory_order_relaxed);
+            }
+        }
+        this->mSubmitted_.fetch_add(1, std::memory_order_relaxed);
+        this->mCv_.notify_one();
+        return true;
+    }
+
+    ComputePoolStats ComputePool::stats() const noexcept
+    {
+        return {
+            this->mSubmitted_.load(std::memory_order_relaxed),
+            this->mCompleted_.load(std::memory_order_relaxed),
+            this->mQueueDepth_.load(std::memory_order_relaxed),
+            this->mPeakQueueDepth_.load(std::memory_order_relaxed),
+        };
+    }
+
+    void ComputePool::workerLoop()
+    {
+        for (;;)
+        {
+            Job job;
+            {
+                std::unique_lock l{this->mMtx_};
+                this->mCv_.wait(l, [this]()->bool { return this->mStopped_ || !this->mJobs_.empty(); });
+                // 停止时丢弃尚未执行的任务，其等待的协程随IoService一同销毁
+                if (this->mStopped_)    return;
+                job = std::move(this->mJobs_.front());
+                this->mJobs_.pop_front();
+                this->mQueueDepth_.store(this->mJobs_.size(), std::memory_order_relaxed);
+            }
+            job();
+            this->mCompleted_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}   // namespace blitz
@@ -1,11 +1,57 @@
 #include "connection.h"
+#include <algorithm>
+#include "io_service.h"
+#ifdef __linux__
+#include <unistd.h>
+#endif
 
 namespace blitz
 {
+    namespace detail
+    {
+        void RecvSizeEstimator::update(std::size_t transferredBytes) noexcept
+        {
+            this->mAverage_ = this->mAverage_ - this->mAverage_ / 8 + transferredBytes / 8;
+            if (transferredBytes >= this->mTarget_)
+            {
+                // 本次读满了接收区，说明仍有数据排队：直接翻倍
+                this->mTarget_ = std::min(this->mTarget_ * 2, MaxTarget);
+                return;
+            }
+            std::size_t target = (2 * this->mAverage_ + MinTarget - 1) / MinTarget * MinTarget;
+            this->mTarget_ = std::clamp(target, MinTarget, MaxTarget);
+        }
+    }   // namespace detail
+
     Connection::Connection(SocketDescriptor socket)
-        : Event{socket}
+        : Event{socket}, mReadCount_{0}, mReadBytes_{0}, mWriteBytes_{0}, mCpuNs_{0}
+        , mTrafficSnapshot_{0, 0, 0}, mMigrateTarget_{nullptr}, mLastActiveTime_{std::chrono::steady_clock::now()}, mEventQueue_{nullptr}
+        , mIoError_{make_error_code(ErrorCode::Success), make_error_code(ErrorCode::Success)}, mInflight_{false, false}
+        , mOffloaded_{false}, mCloseDeferred_{false}, mSlotToken_{0}, mOwner_{nullptr}, mExpiredTimeout_{TimeoutKind::IDLE}, mWriteHighWater_{0}
     {
+        for (std::size_t i = 0; i < std::size(this->mTimeoutNodes_); ++i)
+        {
+            this->mTimeoutNodes_[i].conn = this;
+            this->mTimeoutNodes_[i].kind = static_cast<TimeoutKind>(i);
+        }
+    }
 
+    Connection::~Connection()
+    {
+#ifdef __linux__
+        if (-1 != this->mSplicePipe_.fds[0])
+        {
+            ::close(this->mSplicePipe_.fds[0]);
+            ::close(this->mSplicePipe_.fds[1]);
+        }
+#endif
+    }
+
+    void Connection::onRecvCompleted(std::size_t transferredBytes)
+    {
+        ++this->mReadCount_;
+        this->mReadBytes_ += transferredBytes;
+        this->mRecvState_.estimator.update(transferredBytes);
     }
 
     void Connection::close()
@@ -13,6 +59,16 @@ namespace blitz
         this->setEvent(EventType::CLOSING);
     }
 
+    bool Connection::requestClose()
+    {
+        // 令牌在设置所属IoService之前写入，acquire后读到的令牌与其对应
+        if (auto* owner = this->mOwner_.load(std::memory_order_acquire); owner)
+        {
+            return owner->requestClose(this, this->slotToken());
+        }
+        return false;
+    }
+
     std::size_t Connection::read(std::span<char> buf, std::error_code& err)
     {
         std::size_t n = this->mInputBuf_.readFromBuffer(buf);
@@ -26,4 +82,120 @@ namespace blitz
         err = (0 == n) ? ErrorCode::InternalError : ErrorCode::Success;
         return n;
     }
+
+    std::size_t Connection::write(const SharedBuffer& buf, std::error_code& err)
+    {
+        std::size_t n = this->mOutputBuf_.appendShared(buf);
+        err = (0 == n) ? ErrorCode::InternalError : ErrorCode::Success;
+        return n;
+    }
+
+    std::size_t Connection::writeFile(int fd, std::size_t offset, std::size_t len, std::error_code& err)
+    {
+        std::size_t n = this->mOutputBuf_.appendFile(fd, offset, len);
+        err = (0 == n) ? ErrorCode::InternalError : ErrorCode::Success;
+        return n;
+    }
+
+    std::size_t Connection::readUntil(std::string_view delim, std::span<char> buf, std::error_code& err)
+    {
+        std::size_t pos = this->mInputBuf_.find(delim);
+        if (ChainBuffer::npos == pos)
+        {
+            err = ErrorCode::DelimiterNotFound;
+            return 0;
+        }
+        std::size_t len = pos + delim.size();
+        if (len > buf.size())
+        {
+            err = ErrorCode::BufferTooSmall;
+            return 0;
+        }
+        err = ErrorCode::Success;
+        return this->mInputBuf_.readFromBuffer(buf.first(len));
+    }
+
+    Task<std::size_t> Connection::asyncRead(std::span<char> buf, std::error_code& err)
+    {
+        if (0 == this->mInputBuf_.readableBytes())
+        {
+            if (err = co_await IoTaskAwaiter{this->mEventQueue_, this, IoOpKind::READ}; err != ErrorCode::Success)
+            {
+                co_return 0;
+            }
+        }
+        co_return this->read(buf, err);
+    }
+
+    Task<std::size_t> Connection::asyncReadUntil(std::string_view delim, std::error_code& err)
+    {
+        std::size_t pos = this->mInputBuf_.find(delim);
+        while (ChainBuffer::npos == pos)
+        {
+            std::size_t before = this->mInputBuf_.readableBytes();
+            if (err = co_await IoTaskAwaiter{this->mEventQueue_, this, IoOpKind::READ}; err != ErrorCode::Success)
+            {
+                co_return 0;
+            }
+            if (this->mInputBuf_.readableBytes() == before)
+            {
+                // 对端已关闭，分隔符不会再到达
+                err = ErrorCode::PeerClosed;
+                co_return 0;
+            }
+            pos = this->mInputBuf_.find(delim);
+        }
+        err = ErrorCode::Success;
+        co_return pos + delim.size();
+    }
+
+    Task<std::size_t> Connection::asyncWrite(std::span<const char> buf, std::error_code& err)
+    {
+        std::size_t n = this->write(buf, err);
+        if (err != ErrorCode::Success)  co_return 0;
+        err = co_await this->drainIfAboveHighWater();
+        co_return (err == ErrorCode::Success) ? n : 0;
+    }
+
+    Task<std::size_t> Connection::asyncWrite(const SharedBuffer& buf, std::error_code& err)
+    {
+        std::size_t n = this->write(buf, err);
+        if (err != ErrorCode::Success)  co_return 0;
+        err = co_await this->drainIfAboveHighWater();
+        co_return (err == ErrorCode::Success) ? n : 0;
+    }
+
+    Task<std::error_code> Connection::asyncFlush()
+    {
+        if (0 == this->mOutputBuf_.readableBytes() && !this->isInflight(IoOpKind::WRITE))
+        {
+            co_return make_error_code(ErrorCode::Success);
+        }
+        // 短写与文件段的续写由事件循环完成，写缓冲区清空后才恢复
+        co_return co_await IoTaskAwaiter{this->mEventQueue_, this, IoOpKind::WRITE};
+    }
+
+    Task<std::error_code> Connection::drainIfAboveHighWater()
+    {
+        if (this->mOutputBuf_.readableBytes() > this->mWriteHighWater_)
+        {
+            co_return co_await this->asyncFlush();
+        }
+        if (!this->isInflight(IoOpKind::WRITE))
+        {
+            // 未超过高水位：启动后台写出即返回，之前后台写出的错误在此报告一次后清除
+            if (auto ec = this->ioError(IoOpKind::WRITE); ec != ErrorCode::Success)
+            {
+                this->setIoError(IoOpKind::WRITE, make_error_code(ErrorCode::Success));
+                co_return ec;
+            }
+            // 没有待写数据（空写或已全部写出）时不提交空写
+            if (0 == this->mOutputBuf_.readableBytes())
+            {
+                co_return make_error_code(ErrorCode::Success);
+            }
+            co_return this->mEventQueue_->submitIoEvent(this, IoOpKind::WRITE);
+        }
+        co_return make_error_code(ErrorCode::Success);
+    }
 }   // namespace blitz
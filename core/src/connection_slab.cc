@@ -0,0 +1,58 @@
+#include "connection_slab.h"
+#include "connection.h"
+
+namespace blitz
+{
+    std::uint32_t ConnectionSlab::insert(Connection* conn)
+    {
+        std::uint32_t slot = this->mFreeHead_;
+        if (InvalidSlot != slot)
+        {
+            this->mFreeHead_ = this->mSlots_[slot].nextFree;
+        }
+        else
+        {
+            if (this->mSlots_.size() >= MaxSlotNum)
+            {
+                return InvalidSlot;
+            }
+            slot = static_cast<std::uint32_t>(this->mSlots_.size());
+            this->mSlots_.push_back({nullptr, 0, InvalidSlot, 0});
+        }
+        auto& s = this->mSlots_[slot];
+        s.conn = conn;
+        s.nextFree = InvalidSlot;
+        s.liveIdx = static_cast<std::uint32_t>(this->mLive_.size());
+        this->mLive_.push_back(slot);
+        ++this->mSize_;
+        conn->setSlotToken(MakeToken(slot, s.generation));
+        return slot;
+    }
+
+    void ConnectionSlab::remove(std::uint32_t slot)
+    {
+        auto& s = this->mSlots_[slot];
+        if (!s.conn)    return;
+        s.conn->setSlotToken(0);
+        s.conn = nullptr;
+        // 与末尾交换后移出在用列表
+        std::uint32_t moved = this->mLive_.back();
+        this->mLive_[s.liveIdx] = moved;
+        this->mSlots_[moved].liveIdx = s.liveIdx;
+        this->mLive_.pop_back();
+        // 代数加一，使仍在途的旧操作完成事件失效
+        ++s.generation;
+        s.nextFree = this->mFreeHead_;
+        this->mFreeHead_ = slot;
+        --this->mSize_;
+    }
+
+    Connection* ConnectionSlab::resolve(std::uint64_t token) const noexcept
+    {
+        if (!IsToken(token))    return nullptr;
+        std::uint32_t slot = TokenSlot(token);
+        if (slot >= this->mSlots_.size())   return nullptr;
+        auto& s = this->mSlots_[slot];
+        return (s.generation == TokenGeneration(token)) ? s.conn : nullptr;
+    }
+}   // namespace blitz
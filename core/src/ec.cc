@@ -19,6 +19,12 @@ namespace blitz
     
         case ErrorCode::InternalError:
             return ::strerror(errno);
+
+        case ErrorCode::DelimiterNotFound:
+            return "Delimiter not found";
+
+        case ErrorCode::BufferTooSmall:
+            return "Buffer too small";
         }
         return "Invalid Error Code";
     }
@@ -1,9 +1,15 @@
 #include "event_queue.h"
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
 #include <iostream>
+#include <utility>
 
 #ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
 #include <unistd.h>
 #elif _WIN32
 
@@ -11,11 +17,15 @@
 
 #include "acceptor.h"
 #include "connection.h"
+#include "connection_slab.h"
+#include "probes.h"
 
 namespace blitz
 {
 #ifdef __linux__
     constexpr static int QUEUE_SIZE = 64;
+    // 单次splice的最大字节数，不超过管道默认容量
+    constexpr static std::size_t SPLICE_CHUNK_SIZE = 65536;
 
     int SignalEvent::curSig;
     int SignalEvent::sigFd[2];
@@ -104,8 +114,30 @@ namespace blitz
         }
 	}
 
+    WakeupEvent::WakeupEvent()
+        : Event{-1}, mCounter_{0}
+    {
+        this->mSocket_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (-1 == this->mSocket_)
+        {
+            throw std::system_error(make_error_code(ErrorCode::InternalError));
+        }
+        this->setEvent(EventType::WAKEUP);
+    }
+
+    WakeupEvent::~WakeupEvent()
+    {
+        ::close(this->mSocket_);
+    }
+
+    void WakeupEvent::notify() noexcept
+    {
+        std::uint64_t one = 1;
+        ::write(this->mSocket_, &one, sizeof(one));
+    }
+
     LinuxEventQueue::LinuxEventQueue()
-        : mCompletionQueue_{nullptr}
+        : mCompletionQueue_{nullptr}, mSlab_{nullptr}, mLastOp_{IoOpKind::READ}, mLoopClock_{nullptr}, mLastRes_{0}, mStages_{nullptr}
     {
         if (int err = ::io_uring_queue_init(QUEUE_SIZE, &this->mRing_, 0); 0 != err)
         {
@@ -115,7 +147,7 @@ namespace blitz
     }
 
     LinuxEventQueue::LinuxEventQueue(LinuxEventQueue&& rhs)
-        : mCompletionQueue_{nullptr}
+        : mCompletionQueue_{nullptr}, mSlab_{nullptr}, mLastOp_{IoOpKind::READ}, mLoopClock_{nullptr}, mLastRes_{0}, mStages_{nullptr}
     {
         *this = std::move(rhs);
     }
@@ -126,7 +158,13 @@ namespace blitz
         {
             this->mRing_ = std::move(rhs.mRing_);
             this->mCompletionQueue_ = rhs.mCompletionQueue_;
+            this->mSlab_ = rhs.mSlab_;
+            this->mLastOp_ = rhs.mLastOp_;
+            this->mLoopClock_ = rhs.mLoopClock_;
+            this->mLastRes_ = rhs.mLastRes_;
+            this->mStages_ = rhs.mStages_;
             rhs.mCompletionQueue_ = nullptr;
+            rhs.mSlab_ = nullptr;
         }
         return *this;
     }
@@ -136,30 +174,124 @@ namespace blitz
         ::io_uring_queue_exit(&this->mRing_);
     }
 
+    std::error_code LinuxEventQueue::reinit()
+    {
+        struct io_uring ring;
+        if (int err = ::io_uring_queue_init(QUEUE_SIZE, &ring, 0); 0 != err)
+        {
+            errno = -err;
+            return make_error_code(ErrorCode::InternalError);
+        }
+        ::io_uring_queue_exit(&this->mRing_);
+        this->mRing_ = ring;
+        this->mCompletionQueue_ = nullptr;
+        return make_error_code(ErrorCode::Success);
+    }
+
     Event* LinuxEventQueue::waitCompletionEvent(std::error_code& ec)
     {
         Event* ret = nullptr;
         ec = ErrorCode::Success;
-        if (int err = ::io_uring_wait_cqe(&this->mRing_, &this->mCompletionQueue_); err < 0) 
+        // 等待时完成队列中已就绪的事件数
+        BLITZ_PROBE1(wait, ::io_uring_cq_ready(&this->mRing_));
+        int err = ::io_uring_peek_cqe(&this->mRing_, &this->mCompletionQueue_);
+        if (-EAGAIN == err)
+        {
+            // 完成队列为空时才进入内核阻塞等待
+            this->mMetrics_.add(Metric::URING_ENTERS);
+            this->mMetrics_.add(Metric::CQE_WAITS);
+            err = ::io_uring_wait_cqe(&this->mRing_, &this->mCompletionQueue_);
+        }
+        if (err < 0) 
         {
             errno = -err;
             ec = ErrorCode::InternalError;
         } 
         else
         {
-            auto* event = reinterpret_cast<Event*>(::io_uring_cqe_get_data(this->mCompletionQueue_));
+            if (this->mLoopClock_)
+            {
+                *this->mLoopClock_ = std::chrono::steady_clock::now();
+            }
+            this->mMetrics_.add(Metric::CQES_REAPED);
+            BLITZ_PROBE2(complete, this->mCompletionQueue_->user_data, this->mCompletionQueue_->res);
+            Event* event = nullptr;
+            bool isConnOp = false;
+            if (auto userData = ::io_uring_cqe_get_data64(this->mCompletionQueue_); ConnectionSlab::IsToken(userData))
+            {
+                // 槽位已释放或已被新连接复用的过期完成事件直接丢弃
+                // 操作类型取自令牌而非连接的当前事件，同一连接的读写可同时在途
+                event = this->mSlab_ ? this->mSlab_->resolve(userData) : nullptr;
+                isConnOp = true;
+                this->mLastOp_ = ConnectionSlab::TokenOp(userData);
+            }
+            else
+            {
+                event = reinterpret_cast<Event*>(userData);
+                if (event && (event->isRead() || event->isWrite() || event->isClosed()))
+                {
+                    // 未放入槽位表的连接只能有一个在途操作，由当前事件确定其类型
+                    isConnOp = true;
+                    this->mLastOp_ = event->isRead() ? IoOpKind::READ : (event->isWrite() ? IoOpKind::WRITE : IoOpKind::CLOSE);
+                }
+            }
             if (!event) goto END;
-            if (this->mCompletionQueue_->res < 0)
+            if (isConnOp && IoOpKind::CLOSE != this->mLastOp_ && event->isClosed())
+            {
+                // 已发出关闭的连接：其余在途操作已按fd取消，结果一律丢弃，不再续发IO或恢复协程
+                static_cast<Connection*>(event)->setInflight(this->mLastOp_, false);
+                goto END;
+            }
+            int res = this->mCompletionQueue_->res;
+            this->mLastRes_ = res;
+            if (-ETIME == res && event->isTick())
+            {
+                // 超时操作到期时以-ETIME完成，属正常情况
+                BLITZ_PROBE2(timer_fire, event, res);
+                ret = event;
+            }
+            else if (event->isTimer())
+            {
+                // 定时器无论到期、被取消还是出错都交给上层，由其回收槽位
+                BLITZ_PROBE2(timer_fire, event, res);
+                ret = event;
+            }
+            else if (event->isEndpoint())
+            {
+                // 旁路端点由上层按lastResult()推进会话
+                ret = event;
+            }
+            else if (-ECANCELED == res && isConnOp && IoOpKind::READ == this->mLastOp_
+                     && static_cast<Connection*>(event)->recvState().shrinkRequested)
+            {
+                ret = this->handleCanceledRead(static_cast<Connection*>(event), ec);
+            }
+            else if (-ECANCELED == res && isConnOp && IoOpKind::READ == this->mLastOp_
+                     && static_cast<Connection*>(event)->recvState().migrateRequested)
             {
-                if (this->mCompletionQueue_->res == -ECONNRESET || this->mCompletionQueue_->res == -ENOTCONN)
+                // 迁移取消的读：复位读状态后交给上层，migrateRequested保持为true
+                auto* conn = static_cast<Connection*>(event);
+                conn->recvState().polling = false;
+                conn->recvState().pollDone = false;
+                conn->readBuffer().destroyWriteableIovecs();
+                ret = conn;
+            }
+            else if (res < 0)
+            {
+                if (res == -ECONNRESET || res == -ENOTCONN)
                 {
                     ec = ErrorCode::PeerClosed;
                 }
                 else
                 {
-                    errno = -this->mCompletionQueue_->res;
+                    errno = -res;
                     ec = ErrorCode::InternalError;
                 }
+                if (isConnOp)
+                {
+                    // IO失败也需通知上层，以便恢复等待该IO的协程；关闭失败同样需要回收连接
+                    ret = (IoOpKind::CLOSE == this->mLastOp_) ? event : this->handleIoError(static_cast<Connection*>(event), this->mLastOp_);
+                }
             }
             else
             {
@@ -167,13 +299,14 @@ namespace blitz
                 {
                     ret = this->handleAccept(event);
                 } 
-                else if (event->isClosed() || event->isSignal() || event->isTick())
+                else if (isConnOp)
                 {
-                    ret = event;
+                    ret = (IoOpKind::CLOSE == this->mLastOp_) ? event : this->handleIo(static_cast<Connection*>(event), this->mLastOp_, ec);
                 }
                 else
                 {
-                    ret = this->handleIo(event);
+                    // 信号、定时、唤醒事件
+                    ret = event;
                 }
             }
         }
@@ -185,42 +318,213 @@ namespace blitz
     Event* LinuxEventQueue::handleAccept(Event* event)
     {
         // 连接完成事件
+        this->mMetrics_.add(Metric::ACCEPTS);
+        BLITZ_PROBE1(accept, this->mCompletionQueue_->res);
         auto* clt = new Connection(this->mCompletionQueue_->res);
         clt->setEvent(EventType::ACCEPT);
         return clt;
     }
 
-    Event* LinuxEventQueue::handleIo(Event* event)
+    Event* LinuxEventQueue::handleIo(Connection* conn, IoOpKind op, std::error_code& ec)
     {
         // IO完成事件
         std::size_t transferredBytes = this->mCompletionQueue_->res;
-        if (event->isRead())
+        if (IoOpKind::READ == op)
         {   
+            auto& recv = conn->recvState();
+            recv.shrinkRequested = false;
+            recv.migrateRequested = false;
+            if (recv.polling)
+            {
+                // 连接已可读，此时才分配读缓冲区并提交读；该中间步骤不通知上层
+                recv.polling = false;
+                recv.pollDone = true;
+                ec = this->submitIoEvent(conn, IoOpKind::READ);
+                return (ec == ErrorCode::Success) ? nullptr : conn;
+            }
+            if (this->mStages_)
+            {
+                auto& stamps = conn->stageStamps();
+                auto now = this->mStages_->recordSince(Stage::READ, std::exchange(stamps.readSubmitted, 0));
+                // 响应阶段从读完成起算，至写缓冲区清空为止
+                stamps.readCompleted = this->mStages_->sample(Stage::RESPONSE) ? (now ? now : StageHistograms::Now()) : 0;
+            }
             // 内核向用户读缓冲区写入数据
-            static_cast<Connection*>(event)->readBuffer().moveWriteableAreaIdx(transferredBytes);
-            static_cast<Connection*>(event)->readBuffer().destroyWriteableIovecs();
+            this->mMetrics_.add(Metric::BYTES_IN, transferredBytes);
+            conn->readBuffer().moveWriteableAreaIdx(transferredBytes);
+            conn->readBuffer().destroyWriteableIovecs();
+            conn->onRecvCompleted(transferredBytes);
         }
-        else if (event->isWrite())
+        else
         {
-            // 内核从用户写缓冲区读出数据
-            static_cast<Connection*>(event)->writeBuffer().moveReadableAreaIdx(transferredBytes);
-            static_cast<Connection*>(event)->writeBuffer().destroyReadableIovecs();
+            auto& pipe = conn->splicePipe();
+            if (pipe.stage == detail::SpliceStage::TO_PIPE)
+            {
+                pipe.stage = detail::SpliceStage::NONE;
+                if (0 == transferredBytes)
+                {
+                    // 文件实际长度不足，丢弃该文件段的剩余部分
+                    FileRegion region;
+                    conn->writeBuffer().frontFileRegion(region);
+                    conn->writeBuffer().moveReadableAreaIdx(region.len);
+                    return this->continueWrite(conn, ec);
+                }
+                // 数据已进入管道，紧接着提交管道 -> socket；该中间步骤不通知上层
+                pipe.pendingBytes = transferredBytes;
+                ec = this->submitIoEvent(conn, IoOpKind::WRITE);
+                return (ec == ErrorCode::Success) ? nullptr : conn;
+            }
+            else if (pipe.stage == detail::SpliceStage::TO_SOCKET)
+            {
+                pipe.stage = detail::SpliceStage::NONE;
+                pipe.pendingBytes -= transferredBytes;
+                this->mMetrics_.add(Metric::BYTES_OUT, transferredBytes);
+                conn->onSendCompleted(transferredBytes);
+                conn->writeBuffer().moveReadableAreaIdx(transferredBytes);
+            }
+            else
+            {
+                // 内核从用户写缓冲区读出数据
+                this->mMetrics_.add(Metric::BYTES_OUT, transferredBytes);
+                conn->onSendCompleted(transferredBytes);
+                conn->writeBuffer().moveReadableAreaIdx(transferredBytes);
+                conn->writeBuffer().destroyReadableIovecs();
+                if (0 == transferredBytes && conn->writeBuffer().readableBytes() > 0)
+                {
+                    // socket不再接收数据，避免空转
+                    ec = ErrorCode::InternalError;
+                    return conn;
+                }
+            }
+            return this->continueWrite(conn, ec);
         }
-        return event;
+        return conn;
     }
 
-    static std::error_code SubmitHelper(struct io_uring* ring, struct io_uring_sqe* sqe, void* data)
+    Event* LinuxEventQueue::continueWrite(Connection* conn, std::error_code& ec)
     {
-        ::io_uring_sqe_set_data(sqe, data);
-        if (int ret = ::io_uring_submit(ring); ret < 0)
+        // 短写或写出期间又追加了数据：在事件循环内继续提交，直到写缓冲区清空才通知上层一次
+        if (0 == conn->writeBuffer().readableBytes() && 0 == conn->splicePipe().pendingBytes)
+        {
+            this->recordWriteDrained(conn);
+            return conn;
+        }
+        ec = this->submitIoEvent(conn, IoOpKind::WRITE);
+        return (ec == ErrorCode::Success) ? nullptr : conn;
+    }
+
+    void LinuxEventQueue::recordWriteDrained(Connection* conn)
+    {
+        if (!this->mStages_)    return;
+        auto& stamps = conn->stageStamps();
+        auto now = this->mStages_->recordSince(Stage::WRITE, std::exchange(stamps.writeSubmitted, 0));
+        if (auto start = std::exchange(stamps.readCompleted, 0); 0 != start)
+        {
+            this->mStages_->record(Stage::RESPONSE, (now ? now : StageHistograms::Now()) - start);
+        }
+    }
+
+    Event* LinuxEventQueue::handleIoError(Connection* conn, IoOpKind op)
+    {
+        if (IoOpKind::READ == op)
+        {
+            conn->recvState().polling = false;
+            conn->recvState().pollDone = false;
+            conn->readBuffer().destroyWriteableIovecs();
+        }
+        else
+        {
+            conn->splicePipe().stage = detail::SpliceStage::NONE;
+            conn->writeBuffer().destroyReadableIovecs();
+        }
+        return conn;
+    }
+
+    Event* LinuxEventQueue::handleCanceledRead(Connection* conn, std::error_code& ec)
+    {
+        // 空闲连接的在途读已取消：归还读缓冲区，改为等待可读后再分配
+        conn->recvState().shrinkRequested = false;
+        conn->readBuffer().destroyWriteableIovecs();
+        conn->readBuffer().shrink(0);
+        ec = this->submitIoEvent(conn, IoOpKind::READ);
+        return (ec == ErrorCode::Success) ? nullptr : conn;
+    }
+
+    static std::error_code SubmitPending(struct io_uring* ring, MetricsBlock& metrics)
+    {
+        int ret = ::io_uring_submit(ring);
+        metrics.add(Metric::URING_ENTERS);
+        if (ret < 0)
         {
             errno = -ret;
             return ErrorCode::InternalError;
         }
-        else
+        metrics.add(Metric::SQES_SUBMITTED, ret);
+        return ErrorCode::Success;
+    }
+
+    static std::error_code SubmitHelper(struct io_uring* ring, MetricsBlock& metrics, struct io_uring_sqe* sqe, void* data)
+    {
+        ::io_uring_sqe_set_data(sqe, data);
+        BLITZ_PROBE3(submit, sqe->opcode, sqe->fd, sqe->user_data);
+        return SubmitPending(ring, metrics);
+    }
+
+    // timeout大于0时在sqe之后挂接超时，须已确认有两个空位：到期时取消sqe，超时本身的完成事件user_data为空，被丢弃
+    static std::error_code SubmitLinkedTimeout(struct io_uring* ring, MetricsBlock& metrics, struct io_uring_sqe* sqe, void* data, std::chrono::milliseconds timeout)
+    {
+        if (timeout.count() <= 0)
         {
-            return ErrorCode::Success;
+            return SubmitHelper(ring, metrics, sqe, data);
         }
+        // 内核在提交时读取时长，提交在本函数内完成，栈上的timespec即可
+        struct __kernel_timespec ts{};
+        ts.tv_sec = timeout.count() / 1000;
+        ts.tv_nsec = (timeout.count() % 1000) * 1000000;
+        ::io_uring_sqe_set_flags(sqe, IOSQE_IO_LINK);
+        auto* link = ::io_uring_get_sqe(ring);
+        ::io_uring_prep_link_timeout(link, &ts, 0);
+        ::io_uring_sqe_set_data(link, nullptr);
+        return SubmitHelper(ring, metrics, sqe, data);
+    }
+
+    // 连接操作：已放入槽位表的连接以令牌作为user_data，否则退化为连接指针
+    static std::error_code SubmitConnHelper(struct io_uring* ring, MetricsBlock& metrics, struct io_uring_sqe* sqe, Connection* conn, IoOpKind op)
+    {
+        if (0 == conn->slotToken())
+        {
+            return SubmitHelper(ring, metrics, sqe, conn);
+        }
+        ::io_uring_sqe_set_data64(sqe, ConnectionSlab::WithOp(conn->slotToken(), op));
+        BLITZ_PROBE3(submit, sqe->opcode, sqe->fd, sqe->user_data);
+        return SubmitPending(ring, metrics);
+    }
+
+    std::error_code LinuxEventQueue::onQueueFull() noexcept
+    {
+        this->mMetrics_.add(Metric::SUBMIT_QUEUE_FULL);
+        BLITZ_PROBE0(sq_full);
+        return ErrorCode::SubmitQueueFull;
+    }
+
+    IoOpKind LinuxEventQueue::lastCompletedOp() const noexcept
+    {
+        return this->mLastOp_;
+    }
+
+    void LinuxEventQueue::setLoopClock(std::chrono::steady_clock::time_point* clock) noexcept
+    {
+        this->mLoopClock_ = clock;
+    }
+
+    void LinuxEventQueue::setStageHistograms(StageHistograms* stages) noexcept
+    {
+        this->mStages_ = stages;
+    }
+
+    void LinuxEventQueue::setConnectionSlab(ConnectionSlab* slab) noexcept
+    {
+        this->mSlab_ = slab;
     }
 
     std::error_code LinuxEventQueue::submitAccept(Acceptor& acceptor)
@@ -228,16 +532,26 @@ namespace blitz
         auto* sqe = ::io_uring_get_sqe(&this->mRing_);
         if (!sqe) 
         {
-            return ErrorCode::SubmitQueueFull;
+            return this->onQueueFull();
         }
         ::io_uring_prep_accept(sqe, acceptor.socket(), nullptr, nullptr, 0);
-        return SubmitHelper(&this->mRing_, sqe, &acceptor);
+        return SubmitHelper(&this->mRing_, this->mMetrics_, sqe, &acceptor);
     }
 
     // 内核向用户读缓冲区写入数据
     static void ReadFromKernel(struct io_uring_sqe* sqe, Connection* conn)
     {
-        auto iovecs = conn->readBuffer().writeableArea2Iovecs();   
+        auto& recv = conn->recvState();
+        if (0 == conn->readBuffer().capacityBytes() && !recv.pollDone)
+        {
+            // 读缓冲区尚未分配（或已因空闲归还）：先等待可读，避免空闲连接长期占用内存
+            ::io_uring_prep_poll_add(sqe, conn->socket(), POLLIN);
+            recv.polling = true;
+            return;
+        }
+        recv.pollDone = false;
+        // 接收区大小随连接的流量特征自适应
+        auto iovecs = conn->readBuffer().writeableArea2Iovecs(recv.estimator.target());   
         ::io_uring_prep_readv(sqe, conn->socket(), iovecs.data(), iovecs.size(), 0);
     }
 
@@ -248,33 +562,96 @@ namespace blitz
         ::io_uring_prep_writev(sqe, conn->socket(), iovecs.data(), iovecs.size(), 0);
     }
 
+    // 文件段经管道中转发送：先 文件 -> 管道，完成后再 管道 -> socket
+    static void SpliceIntoKernel(struct io_uring_sqe* sqe, Connection* conn, const FileRegion& region)
+    {
+        auto& pipe = conn->splicePipe();
+        if (pipe.pendingBytes > 0)
+        {
+            // 管道中仍有上次未发完的数据
+            ::io_uring_prep_splice(sqe, pipe.fds[0], -1, conn->socket(), -1, pipe.pendingBytes, SPLICE_F_MOVE);
+            pipe.stage = detail::SpliceStage::TO_SOCKET;
+        }
+        else
+        {
+            std::size_t len = std::min(region.len, SPLICE_CHUNK_SIZE);
+            ::io_uring_prep_splice(sqe, region.fd, region.offset, pipe.fds[1], -1, len, SPLICE_F_MOVE);
+            pipe.stage = detail::SpliceStage::TO_PIPE;
+        }
+    }
+
     std::error_code LinuxEventQueue::submitIoEvent(Connection* conn)
     {
+        return this->submitIoEvent(conn, conn->isRead() ? IoOpKind::READ : IoOpKind::WRITE);
+    }
+
+    std::error_code LinuxEventQueue::submitIoEvent(Connection* conn, IoOpKind op)
+    {
+        FileRegion region;
+        bool isFileRegion = (IoOpKind::WRITE == op) && conn->writeBuffer().frontFileRegion(region);
+        if (isFileRegion && -1 == conn->splicePipe().fds[0])
+        {
+            if (0 != ::pipe2(conn->splicePipe().fds, O_CLOEXEC))
+            {
+                conn->splicePipe().fds[0] = conn->splicePipe().fds[1] = -1;
+                return ErrorCode::InternalError;
+            }
+        }
         auto* sqe = ::io_uring_get_sqe(&this->mRing_);
         if (!sqe)
         {
-            return ErrorCode::SubmitQueueFull;
+            return this->onQueueFull();
         }
-        if (conn->isRead())
+        if (IoOpKind::READ == op)
         {
             ReadFromKernel(sqe, conn);
         }
-        else if (conn->isWrite())
+        else if (isFileRegion)
+        {
+            SpliceIntoKernel(sqe, conn, region);
+        }
+        else
         {
             WriteIntoKernel(sqe, conn);
         }
-        return SubmitHelper(&this->mRing_, sqe, conn);
+        auto ec = SubmitConnHelper(&this->mRing_, this->mMetrics_, sqe, conn, op);
+        if (ec == ErrorCode::Success)
+        {
+            if (this->mStages_ && !conn->isInflight(op))
+            {
+                // 新发起的读/写才开始计时，续读（等待可读之后）与续写沿用原起点
+                auto& stamp = (IoOpKind::READ == op) ? conn->stageStamps().readSubmitted : conn->stageStamps().writeSubmitted;
+                stamp = this->mStages_->sample((IoOpKind::READ == op) ? Stage::READ : Stage::WRITE) ? StageHistograms::Now() : 0;
+            }
+            if (this->mLoopClock_)
+            {
+                conn->onSubmitted(op, *this->mLoopClock_);
+            }
+            conn->setInflight(op, true);
+        }
+        return ec;
     }
 
     std::error_code LinuxEventQueue::submitCloseConn(Connection* conn)
     {
-        auto* sqe = ::io_uring_get_sqe(&this->mRing_);
-        if (!sqe)
+        // 仍有在途读写时先按fd取消该连接的全部操作，关闭以硬链接排在取消之后：
+        // 关闭不必等待对端发送数据，取消失败（操作恰好已完成）也不影响关闭
+        bool hasInflight = conn->isInflight(IoOpKind::READ) || conn->isInflight(IoOpKind::WRITE);
+        if (::io_uring_sq_space_left(&this->mRing_) < (hasInflight ? 2u : 1u))
         {
-            return ErrorCode::SubmitQueueFull;
+            return this->onQueueFull();
         }
+        if (hasInflight)
+        {
+            auto* cancel = ::io_uring_get_sqe(&this->mRing_);
+            ::io_uring_prep_cancel_fd(cancel, conn->socket(), IORING_ASYNC_CANCEL_ALL);
+            ::io_uring_sqe_set_data(cancel, nullptr);
+            ::io_uring_sqe_set_flags(cancel, IOSQE_IO_HARDLINK);
+        }
+        BLITZ_PROBE2(close, conn->socket(), hasInflight);
+        auto* sqe = ::io_uring_get_sqe(&this->mRing_);
         ::io_uring_prep_close(sqe, conn->socket());
-        return SubmitHelper(&this->mRing_, sqe, conn);
+        return SubmitConnHelper(&this->mRing_, this->mMetrics_, sqe, conn, IoOpKind::CLOSE);
     }
 
     std::error_code LinuxEventQueue::submitSysSignal(int sig)
@@ -282,12 +659,12 @@ namespace blitz
         auto* sqe = ::io_uring_get_sqe(&this->mRing_);
         if (!sqe)
         {
-            return ErrorCode::SubmitQueueFull;
+            return this->onQueueFull();
         }
         ::signal(sig, &SignalEvent::SignalHandle);
         auto& sev = SignalEvent::instance();
         ::io_uring_prep_read(sqe, sev.readPipe(), &sev.curSignal(), sizeof(sev.curSignal()), 0);
-        auto ec = SubmitHelper(&this->mRing_, sqe, &sev);
+        auto ec = SubmitHelper(&this->mRing_, this->mMetrics_, sqe, &sev);
         if (ec != ErrorCode::Success)
         {
             ::signal(sig, SIG_DFL);
@@ -300,11 +677,123 @@ namespace blitz
         auto* sqe = ::io_uring_get_sqe(&this->mRing_);
         if (!sqe)
         {
-            return ErrorCode::SubmitQueueFull;
+            return this->onQueueFull();
         }
         auto& tev = TickEvent::instance();
         ::io_uring_prep_read(sqe, tev.fd(), &tev.tickCount(), sizeof(tev.tickCount()), 0);
-        return SubmitHelper(&this->mRing_, sqe, &tev);
+        return SubmitHelper(&this->mRing_, this->mMetrics_, sqe, &tev);
+    }
+
+    std::error_code LinuxEventQueue::submitTimeout(TimeoutEvent* ev, std::chrono::milliseconds timeoutMs)
+    {
+        auto* sqe = ::io_uring_get_sqe(&this->mRing_);
+        if (!sqe)
+        {
+            return this->onQueueFull();
+        }
+        ev->timespec().tv_sec = timeoutMs.count() / 1000;
+        ev->timespec().tv_nsec = (timeoutMs.count() % 1000) * 1000000;
+        ::io_uring_prep_timeout(sqe, &ev->timespec(), 0, 0);
+        return SubmitHelper(&this->mRing_, this->mMetrics_, sqe, ev);
+    }
+
+    std::error_code LinuxEventQueue::submitTimeoutAt(TimeoutEvent* ev, std::chrono::steady_clock::time_point deadline)
+    {
+        auto* sqe = ::io_uring_get_sqe(&this->mRing_);
+        if (!sqe)
+        {
+            return this->onQueueFull();
+        }
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+        ev->timespec().tv_sec = ns / 1000000000;
+        ev->timespec().tv_nsec = ns % 1000000000;
+        ::io_uring_prep_timeout(sqe, &ev->timespec(), 0, IORING_TIMEOUT_ABS);
+        return SubmitHelper(&this->mRing_, this->mMetrics_, sqe, ev);
+    }
+
+    std::error_code LinuxEventQueue::submitTimeoutRemove(TimeoutEvent* ev)
+    {
+        auto* sqe = ::io_uring_get_sqe(&this->mRing_);
+        if (!sqe)
+        {
+            return this->onQueueFull();
+        }
+        // 移除操作自身的完成事件无需处理
+        ::io_uring_prep_timeout_remove(sqe, reinterpret_cast<std::uint64_t>(ev), 0);
+        return SubmitHelper(&this->mRing_, this->mMetrics_, sqe, nullptr);
+    }
+
+    std::error_code LinuxEventQueue::submitCancel(Connection* conn)
+    {
+        auto* sqe = ::io_uring_get_sqe(&this->mRing_);
+        if (!sqe)
+        {
+            return this->onQueueFull();
+        }
+        // 取消操作自身的完成事件无需处理
+        if (0 == conn->slotToken())
+        {
+            ::io_uring_prep_cancel(sqe, conn, 0);
+        }
+        else
+        {
+            ::io_uring_prep_cancel64(sqe, ConnectionSlab::WithOp(conn->slotToken(), IoOpKind::READ), 0);
+        }
+        return SubmitHelper(&this->mRing_, this->mMetrics_, sqe, nullptr);
+    }
+
+    std::error_code LinuxEventQueue::submitWakeup(WakeupEvent* ev)
+    {
+        auto* sqe = ::io_uring_get_sqe(&this->mRing_);
+        if (!sqe)
+        {
+            return this->onQueueFull();
+        }
+        ::io_uring_prep_read(sqe, ev->socket(), &ev->counter(), sizeof(ev->counter()), 0);
+        return SubmitHelper(&this->mRing_, this->mMetrics_, sqe, ev);
+    }
+
+    std::error_code LinuxEventQueue::submitRecv(Event* ev, std::span<char> buf, std::chrono::milliseconds timeout)
+    {
+        if (::io_uring_sq_space_left(&this->mRing_) < (timeout.count() > 0 ? 2u : 1u))
+        {
+            return this->onQueueFull();
+        }
+        auto* sqe = ::io_uring_get_sqe(&this->mRing_);
+        ::io_uring_prep_recv(sqe, ev->socket(), buf.data(), buf.size(), 0);
+        return SubmitLinkedTimeout(&this->mRing_, this->mMetrics_, sqe, ev, timeout);
+    }
+
+    std::error_code LinuxEventQueue::submitSend(Event* ev, std::span<const char> buf, std::chrono::milliseconds timeout)
+    {
+        if (::io_uring_sq_space_left(&this->mRing_) < (timeout.count() > 0 ? 2u : 1u))
+        {
+            return this->onQueueFull();
+        }
+        auto* sqe = ::io_uring_get_sqe(&this->mRing_);
+        ::io_uring_prep_send(sqe, ev->socket(), buf.data(), buf.size(), MSG_NOSIGNAL);
+        return SubmitLinkedTimeout(&this->mRing_, this->mMetrics_, sqe, ev, timeout);
+    }
+
+    std::error_code LinuxEventQueue::submitClose(Event* ev)
+    {
+        auto* sqe = ::io_uring_get_sqe(&this->mRing_);
+        if (!sqe)
+        {
+            return this->onQueueFull();
+        }
+        ::io_uring_prep_close(sqe, ev->socket());
+        return SubmitHelper(&this->mRing_, this->mMetrics_, sqe, ev);
+    }
+
+    std::int32_t LinuxEventQueue::lastResult() const noexcept
+    {
+        return this->mLastRes_;
+    }
+
+    const MetricsBlock& LinuxEventQueue::metrics() const noexcept
+    {
+        return this->mMetrics_;
     }
 
 #elif _WIN32
@@ -0,0 +1,135 @@
+#include "frame_arena.h"
+#include <new>
+
+namespace blitz
+{
+    namespace detail
+    {
+        constexpr static std::uint32_t NoBucket = static_cast<std::uint32_t>(-1);
+
+        struct alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) FrameHeader
+        {
+            FrameArena* arena;
+            std::uint32_t bucket;
+        };
+
+        FrameArena*& CurrentFrameArena() noexcept
+        {
+            thread_local FrameArena* sCurrentFrameArena = nullptr;
+            return sCurrentFrameArena;
+        }
+    }   // namespace detail
+
+    FrameArena::FrameArena()
+        : mAllocCount_{0}, mPoolHits_{0}, mOversizeCount_{0}, mLiveFrames_{0}, mMaxFrameSize_{0}
+    {
+        this->mFreeLists_.fill(nullptr);
+        this->mFreeSizes_.fill(0);
+        for (auto& n : this->mBucketAllocs_)
+        {
+            n.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    FrameArena::~FrameArena()
+    {
+        for (auto* node : this->mFreeLists_)
+        {
+            while (node)
+            {
+                auto* next = node->next;
+                ::operator delete(node);
+                node = next;
+            }
+        }
+    }
+
+    void* FrameArena::Allocate(FrameArena* arena, std::size_t size)
+    {
+        if (arena)
+        {
+            return arena->allocate(size);
+        }
+        auto* header = static_cast<detail::FrameHeader*>(::operator new(sizeof(detail::FrameHeader) + size));
+        header->arena = nullptr;
+        header->bucket = detail::NoBucket;
+        return header + 1;
+    }
+
+    void FrameArena::Deallocate(void* frame) noexcept
+    {
+        if (!frame) return;
+        auto* header = static_cast<detail::FrameHeader*>(frame) - 1;
+        if (!header->arena)
+        {
+            ::operator delete(header);
+            return;
+        }
+        header->arena->deallocate(header, header->bucket);
+    }
+
+    FrameArenaStats FrameArena::stats() const noexcept
+    {
+        return {
+            this->mAllocCount_.load(std::memory_order_relaxed),
+            this->mPoolHits_.load(std::memory_order_relaxed),
+            this->mOversizeCount_.load(std::memory_order_relaxed),
+            this->mLiveFrames_.load(std::memory_order_relaxed),
+            this->mMaxFrameSize_.load(std::memory_order_relaxed),
+        };
+    }
+
+    void* FrameArena::allocate(std::size_t size)
+    {
+        this->mAllocCount_.fetch_add(1, std::memory_order_relaxed);
+        this->mLiveFrames_.fetch_add(1, std::memory_order_relaxed);
+        if (size > this->mMaxFrameSize_.load(std::memory_order_relaxed))
+        {
+            // 仅本线程写入，无需CAS
+            this->mMaxFrameSize_.store(size, std::memory_order_relaxed);
+        }
+
+        std::size_t total = sizeof(detail::FrameHeader) + size;
+        std::size_t bucket = (total + BucketGranularity - 1) / BucketGranularity - 1;
+        detail::FrameHeader* header = nullptr;
+        if (bucket >= BucketNum)
+        {
+            this->mOversizeCount_.fetch_add(1, std::memory_order_relaxed);
+            header = static_cast<detail::FrameHeader*>(::operator new(total));
+            header->bucket = detail::NoBucket;
+        }
+        else
+        {
+            this->mBucketAllocs_[bucket].fetch_add(1, std::memory_order_relaxed);
+            if (auto* node = this->mFreeLists_[bucket]; node)
+            {
+                this->mFreeLists_[bucket] = node->next;
+                --this->mFreeSizes_[bucket];
+                this->mPoolHits_.fetch_add(1, std::memory_order_relaxed);
+                header = reinterpret_cast<detail::FrameHeader*>(node);
+            }
+            else
+            {
+                // 按分桶上限分配，归还后可被同一分桶的任意帧复用
+                header = static_cast<detail::FrameHeader*>(::operator new((bucket + 1) * BucketGranularity));
+            }
+            header->bucket = static_cast<std::uint32_t>(bucket);
+        }
+        header->arena = this;
+        return header + 1;
+    }
+
+    void FrameArena::deallocate(void* block, std::uint32_t bucket) noexcept
+    {
+        this->mLiveFrames_.fetch_sub(1, std::memory_order_relaxed);
+        if (bucket == detail::NoBucket || this->mFreeSizes_[bucket] >= MaxPooledPerBucket)
+        {
+            ::operator delete(block);
+            return;
+        }
+        auto* node = static_cast<FreeNode*>(block);
+        node->next = this->mFreeLists_[bucket];
+        this->mFreeLists_[bucket] = node;
+        ++this->mFreeSizes_[bucket];
+    }
+}   // namespace blitz
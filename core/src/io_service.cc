@@ -1,11 +1,38 @@
 #include "io_service.h"
+#include <algorithm>
 #include <cerrno>
 #include <cstring>
+#include <memory>
+#include <thread>
+#include <utility>
+#ifdef __linux__
+#include <unistd.h>
+#endif
 #include "connection.h"
-#include "timer.h"
 
 namespace blitz
 {
+    // 每轮事件循环最多执行的投递任务数
+    constexpr static std::size_t PostBatchLimit = 256;
+    // 跨线程交接连接或关闭请求时，队列已满后休眠重试的次数与首次休眠时长（逐次翻倍，合计约1.5ms）；
+    // 休眠而非自旋，过载时不占满accept线程所在的CPU
+    constexpr static std::size_t PostRetryLimit = 5;
+    constexpr static std::chrono::microseconds PostRetryBackoff{50};
+
+    namespace
+    {
+        // 投递中的新连接：任务未执行即随队列销毁（或交接失败）时关闭套接字并释放连接
+        struct PendingConnectionDeleter
+        {
+            void operator()(Connection* conn) const noexcept
+            {
+                ::close(conn->socket());
+                delete conn;
+            }
+        };
+        using PendingConnection = std::unique_ptr<Connection, PendingConnectionDeleter>;
+    }   // namespace
+
     auto AsyncTask::promise_type::get_return_object()
     {
         return AsyncTask{std::coroutine_handle<AsyncTask::promise_type>::from_promise(*this)};
@@ -26,6 +53,21 @@ namespace blitz
         return std::suspend_always{}; 
     }
 
+    void* AsyncTask::promise_type::operator new(std::size_t size, IoService& service, Connection*)
+    {
+        return FrameArena::Allocate(&service.frameArena(), size);
+    }
+
+    void* AsyncTask::promise_type::operator new(std::size_t size)
+    {
+        return FrameArena::Allocate(detail::CurrentFrameArena(), size);
+    }
+
+    void AsyncTask::promise_type::operator delete(void* frame) noexcept
+    {
+        FrameArena::Deallocate(frame);
+    }
+
     AsyncTask::AsyncTask(std::coroutine_handle<> hdl)
         : mCoroutineHandle_{hdl}
     {
@@ -69,7 +111,13 @@ namespace blitz
     }
 
     IoTaskAwaiter::IoTaskAwaiter(EventQueue* q, Connection* conn) 
-        : ec{make_error_code(ErrorCode::Success)}, mConn_{conn}, mEventQueue_{q}
+        : IoTaskAwaiter{q, conn, (conn && conn->isWrite()) ? IoOpKind::WRITE : IoOpKind::READ}
+    {
+
+    }
+
+    IoTaskAwaiter::IoTaskAwaiter(EventQueue* q, Connection* conn, IoOpKind op) 
+        : ec{make_error_code(ErrorCode::Success)}, mConn_{conn}, mOp_{op}, mEventQueue_{q}
     {
 
     }
@@ -79,73 +127,558 @@ namespace blitz
         return false; 
     }
 
-    void IoTaskAwaiter::await_suspend(std::coroutine_handle<> handle) noexcept 
+    bool IoTaskAwaiter::await_suspend(std::coroutine_handle<> handle) noexcept 
     {
-        if (!this->mConn_)  return;
-        this->ec = this->mEventQueue_->submitIoEvent(this->mConn_);
+        if (!this->mConn_)  return false;
+        this->mConn_->setAwaiting(this->mOp_, handle);
+        if (this->mConn_->isInflight(this->mOp_))
+        {
+            // 同方向操作已在途（如后台写出），只等待其完成，不重复提交
+            return true;
+        }
+        this->ec = this->mEventQueue_->submitIoEvent(this->mConn_, this->mOp_);
+        if (this->ec != ErrorCode::Success)
+        {
+            // 提交失败则不挂起，由await_resume返回错误
+            this->mConn_->takeAwaiting(this->mOp_);
+            return false;
+        }
+        return true;
     }
 
     std::error_code IoTaskAwaiter::await_resume() const noexcept
     { 
-        return this->ec; 
+        if (this->ec != ErrorCode::Success || !this->mConn_)  return this->ec;
+        return this->mConn_->ioError(this->mOp_); 
+    }
+
+    OffloadAwaiter::OffloadAwaiter(IoService* service, Connection* conn, ComputePool::Job job)
+        : mService_{service}, mConn_{conn}, mJob_{std::move(job)}
+    {
+
+    }
+
+    bool OffloadAwaiter::await_suspend(std::coroutine_handle<> handle) noexcept
+    {
+        this->mResume_.handle = handle;
+        // 计算线程执行期间本线程不再访问该连接的缓冲区
+        this->mConn_->setEvent(EventType::EMPTY);
+        this->mConn_->setOffloaded(true);
+        bool submitted = this->mService_->computePool()->submit([this]()->void
+        {
+            this->mJob_();
+            // 入队后本对象可能随即被所属线程恢复的协程销毁，此后不可再访问
+            this->mService_->post(&this->mResume_);
+        });
+        if (!submitted)
+        {
+            // 计算线程池已停止，退化为在IO线程上执行
+            this->mJob_();
+        }
+        return submitted;
+    }
+
+    bool OffloadAwaiter::await_resume() noexcept
+    {
+        this->mConn_->setOffloaded(false);
+        bool closeDeferred = this->mConn_->isCloseDeferred();
+        this->mConn_->setCloseDeferred(false);
+        return closeDeferred;
+    }
+
+    namespace
+    {
+        class BusyTimeRecorder
+        {
+        public:
+            BusyTimeRecorder(std::atomic<std::uint64_t>& busyNs, std::chrono::steady_clock::time_point start)
+                : mBusyNs_{busyNs}, mStart_{start} {}
+            ~BusyTimeRecorder()
+            {
+                auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - this->mStart_);
+                // 仅所属线程写入
+                this->mBusyNs_.store(this->mBusyNs_.load(std::memory_order_relaxed) + elapsed.count(), std::memory_order_relaxed);
+            }
+
+        private:
+            std::atomic<std::uint64_t>& mBusyNs_;
+            std::chrono::steady_clock::time_point mStart_;
+        };
+    }   // namespace
+
+    IoService::IoService()
+    {
+        this->mEventQueue_.setConnectionSlab(&this->mSlab_);
+        this->mEventQueue_.setLoopClock(&this->mLoopNow_);
     }
 
     IoService::~IoService()
     {
-        for (auto& [conn, _] : this->mConns_)
+        this->mSlab_.forEach([this](Connection* conn)->void { this->closeConnection(conn); });
+        // 提交队列已满而无法提交关闭的，事件循环不会再运行，直接关闭
+        for (auto* conn : this->mCloseRetries_)
         {
-            this->closeConnection(conn);
+            ::close(conn->socket());
         }
+        // 先于定时器槽位表等成员销毁协程帧，挂起中的sleep可在析构时取消其定时器
+        this->mTasks_.clear();
     }
 
     void IoService::registConnection(Connection* conn)
     {
-        this->mConns_[conn] = this->asyncHandle(conn);
+        this->postConnection(conn, false);
+    }
+
+    void IoService::postConnection(Connection* conn, bool migrated)
+    {
+        this->mActiveConns_.fetch_add(1, std::memory_order_relaxed);
+        // accept时已采样的连接继续记录从注册到接管的耗时
+        if (0 != conn->stageStamps().accepted)
+        {
+            conn->stageStamps().registered = StageHistograms::Now();
+        }
+        // 经无锁队列交给所属线程；所属线程长时间未取走任务时放弃，连接随任务销毁而关闭
+        if (!this->postRetrying([this, owned = PendingConnection{conn}, migrated]() mutable { this->adoptConnection(owned.release(), migrated); }))
+        {
+            this->mActiveConns_.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    void IoService::adoptConnection(Connection* conn, bool migrated)
+    {
+        // 计数只由本线程写入：接管的新连接计入本事件循环的ACCEPTS，迁入的不计
+        if (!migrated)
+        {
+            this->mMetrics_.add(Metric::ACCEPTS);
+        }
+        // 在所属线程上创建处理协程，io_uring提交与协程帧分配均不跨线程
+        std::uint32_t slot = this->mSlab_.insert(conn);
+        if (ConnectionSlab::InvalidSlot == slot)
+        {
+            ::close(conn->socket());
+            this->mActiveConns_.fetch_sub(1, std::memory_order_relaxed);
+            delete conn;
+            return;
+        }
+        if (slot >= this->mTasks_.size())
+        {
+            this->mTasks_.resize(slot + 1);
+        }
+        this->mStages_.recordSince(Stage::REGISTER, std::exchange(conn->stageStamps().registered, 0));
+        conn->setEventQueue(&this->mEventQueue_);
+        conn->setWriteHighWater(this->mWriteHighWater_);
+        conn->setOwner(this);
+        this->mTimer_.add(conn, this->mLoopNow_);
+        this->mTasks_[slot] = this->asyncHandle(conn);
+    }
+
+    bool IoService::post(PostCallback fn)
+    {
+        if (!this->mTaskQueue_.tryPush(PostedTask{std::move(fn), std::chrono::steady_clock::now()}))
+        {
+            return false;
+        }
+        this->signalWakeup();
+        return true;
+    }
+
+    bool IoService::postRetrying(PostCallback fn)
+    {
+        // 在所属线程上等待不到队列被取走，只尝试一次
+        std::size_t limit = (detail::CurrentEventQueue() == &this->mEventQueue_) ? 0 : PostRetryLimit;
+        PostedTask task{std::move(fn), std::chrono::steady_clock::now()};
+        // tryPush仅在成功时移走task，失败后可原样重试
+        auto backoff = PostRetryBackoff;
+        for (std::size_t i = 0; !this->mTaskQueue_.tryPush(std::move(task)); ++i)
+        {
+            if (limit == i) return false;
+            this->signalWakeup();
+            std::this_thread::sleep_for(backoff);
+            backoff *= 2;
+        }
+        this->signalWakeup();
+        return true;
+    }
+
+    bool IoService::dispatch(PostCallback fn)
+    {
+        if (detail::CurrentEventQueue() == &this->mEventQueue_)
+        {
+            fn();
+            return true;
+        }
+        return this->post(std::move(fn));
+    }
+
+    void IoService::signalWakeup() noexcept
+    {
+        // 所属线程取走唤醒前的后续投递不再写eventfd，一批投递只产生一个唤醒完成事件
+        if (!this->mWakeupPending_.exchange(true, std::memory_order_acq_rel))
+        {
+            this->mWakeup_.notify();
+        }
+    }
+
+    void IoService::runPostedTasks()
+    {
+        PostedTask task;
+        std::size_t n = 0;
+        while (n < PostBatchLimit && this->mTaskQueue_.tryPop(task))
+        {
+            ++n;
+            auto latency = std::chrono::steady_clock::now() - task.enqueued;
+            this->mPostLatency_.record(std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count());
+            task.fn();
+            task.fn.reset();
+        }
+        if (PostBatchLimit == n)
+        {
+            // 本批已满，剩余任务留到下一轮，避免饿死IO完成事件
+            this->signalWakeup();
+        }
     }
 
     void IoService::wakeupFromWait()
     {
-        // 注册一个任意事件，唤醒io_uring
-        this->mEventQueue_.submitSysSignal(SIGINT);
+        this->signalWakeup();
+    }
+
+    bool IoService::requestClose(Connection* conn, std::uint64_t token)
+    {
+        // 请求发出后连接可能已关闭或迁出，按令牌确认仍是同一连接
+        auto task = [this, conn, token]()->void
+        {
+            if (this->mSlab_.resolve(token) == conn)
+            {
+                this->closeConnection(conn);
+            }
+        };
+        if (detail::CurrentEventQueue() == &this->mEventQueue_)
+        {
+            task();
+            return true;
+        }
+        return this->postRetrying(std::move(task));
+    }
+
+    void IoService::post(detail::PostedResume* node)
+    {
+        std::size_t depth = this->mPostedDepth_.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (depth > this->mPeakPostedDepth_.load(std::memory_order_relaxed))
+        {
+            this->mPeakPostedDepth_.store(depth, std::memory_order_relaxed);
+        }
+        this->mPosted_.push(node);
+        this->signalWakeup();
+    }
+
+    void IoService::resumePosted()
+    {
+        while (auto* node = this->mPosted_.pop())
+        {
+            this->mPostedDepth_.fetch_sub(1, std::memory_order_relaxed);
+            static_cast<detail::PostedResume*>(node)->handle.resume();
+        }
+    }
+
+    void IoService::setBufferShrinkPolicy(std::chrono::milliseconds idleTime, std::size_t highWaterBytes) noexcept
+    {
+        this->mShrinkIdleTime_ = idleTime;
+        this->mShrinkHighWaterBytes_ = highWaterBytes;
+    }
+
+    void IoService::setTimeoutCallback(TimeoutCallback cb, std::chrono::milliseconds timeoutMs) noexcept
+    {
+        this->mTimer_.registTimeoutCallback([this, cb](Connection* conn)->void
+        {
+            // 读回调在计算线程执行期间不回调用户，Timer已顺延，此处仅作防护
+            if (conn->isOffloaded())    return;
+            this->mMetrics_.add(Metric::TIMER_FIRES);
+            // 已调用close()的连接不再回调，超时即关闭，避免在途IO迟迟不完成时一直等待
+            if (conn->isClosing())
+            {
+                this->closeConnection(conn);
+                return;
+            }
+            if (cb) cb(conn);
+            // 回调中调用了close()则立即关闭，不等待下一次IO完成
+            if (conn->isClosing())
+            {
+                this->closeConnection(conn);
+            }
+        }, timeoutMs);
     }
 
-    void IoService::runOnce(Timer& t)
+    TimerId IoService::runAfter(std::chrono::milliseconds delay, TimerCallback cb)
     {
+        return this->scheduleTimer(std::chrono::steady_clock::now() + delay, std::chrono::milliseconds{0}, std::move(cb));
+    }
+
+    TimerId IoService::runEvery(std::chrono::milliseconds interval, TimerCallback cb)
+    {
+        if (interval.count() <= 0)  return {};
+        return this->scheduleTimer(std::chrono::steady_clock::now() + interval, interval, std::move(cb));
+    }
+
+    bool IoService::cancel(TimerId id)
+    {
+        auto* entry = this->mTimerSlab_.find(id);
+        if (!entry) return false;
+        entry->active = false;
+        // 超时操作在途时待其以-ECANCELED完成后回收；回调执行中取消自身则在回调返回后回收
+        if (entry->inflight)
+        {
+            this->mEventQueue_.submitTimeoutRemove(entry);
+        }
+        return true;
+    }
+
+    TimerId IoService::scheduleTimer(std::chrono::steady_clock::time_point deadline, std::chrono::milliseconds interval, TimerCallback cb)
+    {
+        auto* entry = this->mTimerSlab_.acquire();
+        entry->cb = std::move(cb);
+        entry->deadline = deadline;
+        entry->interval = interval;
+        if (this->mEventQueue_.submitTimeoutAt(entry, deadline) != ErrorCode::Success)
+        {
+            this->mTimerSlab_.release(entry);
+            return {};
+        }
+        entry->active = true;
+        entry->inflight = true;
+        return {entry->slot, entry->generation};
+    }
+
+    void IoService::onTimer(detail::TimerEntry* entry)
+    {
+        entry->inflight = false;
+        if (entry->active)
+        {
+            this->mMetrics_.add(Metric::TIMER_FIRES);
+            entry->cb();
+        }
+        if (!entry->active || 0 == entry->interval.count())
+        {
+            this->mTimerSlab_.release(entry);
+            return;
+        }
+        entry->deadline = std::max(entry->deadline + entry->interval, this->mLoopNow_);
+        if (this->mEventQueue_.submitTimeoutAt(entry, entry->deadline) == ErrorCode::Success)
+        {
+            entry->inflight = true;
+        }
+        else
+        {
+            this->mTimerSlab_.release(entry);
+        }
+    }
+
+    void IoService::setStageSampling(std::uint32_t every) noexcept
+    {
+        this->mStages_.setSampling(every);
+        // 关闭时事件队列不再检查采样，读写路径没有额外开销
+        this->mEventQueue_.setStageHistograms(this->mStages_.enabled() ? &this->mStages_ : nullptr);
+    }
+
+    MetricsSnapshot IoService::metrics() const noexcept
+    {
+        MetricsSnapshot snapshot;
+        this->mEventQueue_.metrics().collect(snapshot);
+        this->mMetrics_.collect(snapshot);
+        snapshot[Metric::ACTIVE_CONNECTIONS] = this->mActiveConns_.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+
+    void IoService::runOnce()
+    {
+        using namespace std::chrono_literals;
+        if (!this->mShrinkTimerArmed_ && this->mShrinkIdleTime_ > 0ms)
+        {
+            this->mShrinkTimerArmed_ = (this->mEventQueue_.submitTimeout(&this->mShrinkTimer_, this->mShrinkIdleTime_) == ErrorCode::Success);
+        }
+        detail::CurrentEventQueueGuard guard{&this->mEventQueue_};
+        detail::CurrentIoServiceGuard serviceGuard{this};
+        detail::FrameArenaGuard arenaGuard{&this->mFrameArena_};
+        if (!this->mWakeupArmed_)
+        {
+            this->mWakeupArmed_ = (this->mEventQueue_.submitWakeup(&this->mWakeup_) == ErrorCode::Success);
+        }
+        if (!this->mTimerTickArmed_ && !this->mTimer_.empty())
+        {
+            this->mTimerTickArmed_ = (this->mEventQueue_.submitTimeout(&this->mTimerTick_, this->mTimerResolution_) == ErrorCode::Success);
+        }
+        if (!this->mMigrateTimerArmed_ && this->mMigrateInterval_ > 0ms)
+        {
+            this->mMigrateTimerArmed_ = (this->mEventQueue_.submitTimeout(&this->mMigrateTimer_, this->mMigrateInterval_) == ErrorCode::Success);
+        }
+        // 上一轮的提交已被内核取走，提交队列有了空位
+        this->retryCloses();
         std::error_code ec;
-        auto* conn = static_cast<Connection*>(this->mEventQueue_.waitCompletionEvent(ec));
-        if (!conn)  return;
-        if (ec != ErrorCode::Success)
+        auto* ev = this->mEventQueue_.waitCompletionEvent(ec);
+        if (!ev)    return;
+        // 本轮的定时检查、活跃时间刷新与耗时统计共用同一个时间戳，由事件队列在取得完成事件后、处理前刷新
+        this->mStages_.applyPendingReset();
+        // 统计处理完成事件的耗时（不含阻塞等待），供按CPU耗时分配连接
+        BusyTimeRecorder busy{this->mBusyNs_, this->mLoopNow_};
+        if (ev == &this->mWakeup_)
         {
-            this->mErrCb_(conn, ec);
+            this->mWakeupArmed_ = false;
+            // 先取走唤醒标记再处理，此后的投递会重新发出唤醒
+            this->mWakeupPending_.exchange(false, std::memory_order_acq_rel);
+            this->runPostedTasks();
+            this->resumePosted();
             return;
         }
-        if (conn->isClosing())
+        if (ev == &this->mShrinkTimer_)
         {
-            this->closeConnection(conn);
+            this->shrinkIdleBuffers();
+            this->mShrinkTimerArmed_ = false;
+            return;
+        }
+        if (ev == &this->mTimerTick_)
+        {
+            this->mTimerTickArmed_ = false;
+            this->mTimer_.tick(this->mLoopNow_);
+            return;
+        }
+        if (ev == &this->mMigrateTimer_)
+        {
+            this->mMigrateTimerArmed_ = false;
+            this->requestMigration();
+            return;
+        }
+        if (ev->isTimer())
+        {
+            this->onTimer(static_cast<detail::TimerEntry*>(ev));
+            return;
+        }
+        if (ev->isTick())
+        {
+            return;
         }
-        else if (conn->isClosed())
+        auto* conn = static_cast<Connection*>(ev);
+        auto op = this->mEventQueue_.lastCompletedOp();
+        if (IoOpKind::CLOSE == op)
         {
-            t.remove(conn);
-            this->mConns_.erase(conn);
+            this->mStages_.recordSince(Stage::CLOSE, conn->stageStamps().closeSubmitted);
+            this->mTimer_.remove(conn);
+            this->releaseSlot(conn);
             delete conn;
+            return;
+        }
+        conn->setInflight(op, false);
+        if (IoOpKind::READ == op && conn->recvState().migrateRequested)
+        {
+            this->migrateOut(conn);
+            return;
+        }
+        if (conn->isClosing())
+        {
+            this->closeConnection(conn);
         }
-        else if (conn->isRead() || conn->isWrite())
+        else
         {
-            // 恢复IO协程
-            this->mConns_[conn].resume();
+            // 按操作类型恢复等待该IO的协程，IO出错时由await_resume返回错误
+            conn->onIoProgress(op, this->mLoopNow_);
+            conn->setIoError(op, ec);
+            if (auto handle = conn->takeAwaiting(op); handle)
+            {
+                handle.resume();
+            }
         }
     }
 
     void IoService::closeConnection(Connection* conn)
     {
-        if (!conn)  return;
+        // 已发出关闭的连接不再重复关闭
+        if (!conn || conn->isClosed())  return;
+        if (conn->isOffloaded())
+        {
+            // 计算线程仍在使用连接，关闭会销毁其所在协程帧，待恢复后由协程关闭
+            conn->setCloseDeferred(true);
+            return;
+        }
+        std::uint64_t submittedAt = this->mStages_.sample(Stage::CLOSE) ? StageHistograms::Now() : 0;
+        if (this->mEventQueue_.submitCloseConn(conn) != ErrorCode::Success)
+        {
+            // 关闭未提交：保持CLOSING，下一轮事件循环重试，期间完成的读写仍按关闭中处理
+            conn->setEvent(EventType::CLOSING);
+            if (std::find(this->mCloseRetries_.begin(), this->mCloseRetries_.end(), conn) == this->mCloseRetries_.end())
+            {
+                this->mCloseRetries_.push_back(conn);
+            }
+            return;
+        }
         conn->setEvent(EventType::CLOSED);
-        this->mEventQueue_.submitCloseConn(conn);
+        conn->stageStamps().closeSubmitted = submittedAt;
+        // 关闭完成前不再触发超时
+        this->mTimer_.remove(conn);
+    }
+
+    void IoService::retryCloses()
+    {
+        if (this->mCloseRetries_.empty())   return;
+        std::vector<Connection*> conns;
+        conns.swap(this->mCloseRetries_);
+        for (auto* conn : conns)
+        {
+            this->closeConnection(conn);
+        }
+    }
+
+    void IoService::trimBuffer(ChainBuffer& buf)
+    {
+        if (buf.capacityBytes() > this->mShrinkHighWaterBytes_)
+        {
+            buf.shrink(this->mShrinkHighWaterBytes_);
+        }
+    }
+
+    void IoService::shrinkIdleBuffers()
+    {
+        auto now = this->mLoopNow_;
+        // 只遍历存活连接，开销与连接数而非槽位表容量成正比
+        this->mSlab_.forEach([this, now](Connection* conn)->void
+        {
+            // 业务逻辑正在计算线程池中执行的连接不可触碰
+            if (conn->isNull())  return;
+            if (now - conn->lastActiveTime() < this->mShrinkIdleTime_)   return;
+            // 没有在途写且写缓冲区为空，可直接归还
+            if (!conn->isInflight(IoOpKind::WRITE) && 0 == conn->writeBuffer().readableBytes())
+            {
+                conn->writeBuffer().shrink(0);
+            }
+            // 读缓冲区被在途读占用：先取消该读，取消完成后由EventQueue归还并改为等待可读
+            auto& recv = conn->recvState();
+            if (conn->isInflight(IoOpKind::READ) && !recv.polling && !recv.shrinkRequested
+                && 0 == conn->readBuffer().readableBytes() && conn->readBuffer().capacityBytes() > 0)
+            {
+                recv.shrinkRequested = (this->mEventQueue_.submitCancel(conn) == ErrorCode::Success);
+            }
+        });
     }
 
     AsyncTask IoService::asyncHandle(Connection* conn)
     {
         if (!conn)  co_return;
+        if (this->mHandler_)
+        {
+            try
+            {
+                co_await this->mHandler_(conn);
+            }
+            catch (...)
+            {
+                if (this->mErrCb_)  this->mErrCb_(conn, make_error_code(ErrorCode::InternalError));
+            }
+            this->closeConnection(conn);
+            co_return;
+        }
+        if (this->mKeepAlive_)
+        {
+            co_await this->asyncHandleKeepAlive(conn);
+            co_return;
+        }
         // 读入缓冲区
         conn->setEvent(EventType::READ);
         if (auto ec = co_await IoTaskAwaiter{&this->mEventQueue_, conn}; ec != ErrorCode::Success)
@@ -155,18 +688,198 @@ namespace blitz
             co_return;
         }
         // 在线程池中执行用户业务逻辑
-        this->mReadCb_(conn);
+        std::uint64_t handlerStart = this->mStages_.sample(Stage::HANDLER) ? StageHistograms::Now() : 0;
+        if (this->mComputePool_)
+        {
+            if (co_await OffloadAwaiter{this, conn, [this, conn]()->void { this->mReadCb_(conn); }})
+            {
+                this->closeConnection(conn);
+                co_return;
+            }
+        }
+        else
+        {
+            this->mReadCb_(conn);
+        }
+        this->mStages_.recordSince(Stage::HANDLER, handlerStart);
+        this->trimBuffer(conn->readBuffer());
         // 写入缓冲区
         if (!conn)  co_return;
+        this->checkHighWater(conn);
         conn->setEvent(EventType::WRITE);
+        // 短写与文件段的续写在事件循环内完成，写缓冲区清空后才恢复
         if (auto ec = co_await IoTaskAwaiter{&this->mEventQueue_, conn}; ec != ErrorCode::Success)
         {
             // 写入出错，执行错误回调
             this->mErrCb_(conn, ec);
             co_return;
         }
+        this->trimBuffer(conn->writeBuffer());
         // 在线程池中执行用户业务逻辑
         this->mWriteCb_(conn);
+        if (conn->isClosing())
+        {
+            this->closeConnection(conn);
+        }
         co_return;
     }
+
+    Task<> IoService::asyncHandleKeepAlive(Connection* conn)
+    {
+        for (;;)
+        {
+            std::size_t before = conn->readableBytes();
+            conn->setEvent(EventType::READ);
+            if (auto ec = co_await IoTaskAwaiter{&this->mEventQueue_, conn}; ec != ErrorCode::Success)
+            {
+                this->mErrCb_(conn, ec);
+                break;
+            }
+            if (conn->readableBytes() == before)
+            {
+                // 读到EOF，对端已关闭
+                break;
+            }
+            bool closing = false;
+            // 同一次读入的流水线请求合计为一个样本
+            std::uint64_t handlerStart = this->mStages_.sample(Stage::HANDLER) ? StageHistograms::Now() : 0;
+            if (this->mComputePool_)
+            {
+                if (co_await OffloadAwaiter{this, conn, [this, conn, &closing]()->void { closing = this->dispatchPipelined(conn); }})
+                {
+                    break;
+                }
+            }
+            else
+            {
+                closing = this->dispatchPipelined(conn);
+            }
+            this->mStages_.recordSince(Stage::HANDLER, handlerStart);
+            this->trimBuffer(conn->readBuffer());
+            // 各请求的响应已在写缓冲区中累积，合并为一次writev发出
+            if (conn->writeBuffer().readableBytes() > 0)
+            {
+                this->checkHighWater(conn);
+                conn->setEvent(EventType::WRITE);
+                auto ec = co_await IoTaskAwaiter{&this->mEventQueue_, conn};
+                if (ec != ErrorCode::Success)
+                {
+                    this->mErrCb_(conn, ec);
+                    break;
+                }
+                this->trimBuffer(conn->writeBuffer());
+                this->mWriteCb_(conn);
+                closing = closing || conn->isClosing();
+            }
+            if (closing)    break;
+        }
+        this->closeConnection(conn);
+    }
+
+    bool IoService::dispatchPipelined(Connection* conn)
+    {
+        // 流水线：读缓冲区中可能已有多个完整请求，反复回调直到回调不再消费数据
+        std::size_t remain = conn->readableBytes();
+        std::size_t before = 0;
+        bool closing = false;
+        auto start = std::chrono::steady_clock::now();
+        do
+        {
+            before = remain;
+            this->mReadCb_(conn);
+            closing = conn->isClosing();
+            remain = conn->readableBytes();
+        } while (!closing && remain > 0 && remain < before);
+        conn->addCpuTime(std::chrono::steady_clock::now() - start);
+        return closing;
+    }
+
+    void IoService::checkHighWater(Connection* conn)
+    {
+        std::size_t buffered = conn->writeBuffer().readableBytes();
+        if (this->mHighWaterCb_ && conn->writeHighWater() > 0 && buffered > conn->writeHighWater())
+        {
+            this->mHighWaterCb_(conn, buffered);
+        }
+    }
+
+    void IoService::releaseSlot(Connection* conn)
+    {
+        if (0 == conn->slotToken())  return;
+        // 先销毁协程帧再释放槽位，槽位代数随之递增
+        std::uint32_t slot = ConnectionSlab::TokenSlot(conn->slotToken());
+        this->mTasks_[slot] = AsyncTask{};
+        this->mSlab_.remove(slot);
+        this->mActiveConns_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void IoService::setMigrationPolicy(std::chrono::milliseconds interval, MigrationTargetFn pickTarget) noexcept
+    {
+        this->mMigrateInterval_ = interval;
+        this->mMigrateTarget_ = pickTarget;
+    }
+
+    void IoService::requestMigration()
+    {
+        std::uint64_t busy = this->mBusyNs_.load(std::memory_order_relaxed);
+        this->mRecentBusyNs_.store(busy - this->mBusySnapshot_, std::memory_order_relaxed);
+        this->mBusySnapshot_ = busy;
+
+        // 以周期内读回调耗时为主、收发字节数为辅挑选最热的可迁移连接，同时更新所有连接的快照
+        Connection* hottest = nullptr;
+        std::uint64_t hottestCpu = 0, hottestBytes = 0;
+        bool migratable = this->mKeepAlive_ && !this->mHandler_;
+        this->mSlab_.forEach([&](Connection* conn)->void
+        {
+            auto cur = conn->trafficStats();
+            auto& snap = conn->trafficSnapshot();
+            std::uint64_t cpu = cur.cpuNs - snap.cpuNs;
+            std::uint64_t bytes = (cur.readBytes - snap.readBytes) + (cur.writeBytes - snap.writeBytes);
+            snap = cur;
+            // 仅迁移请求间空闲的连接：只有一个在途读、没有待发数据、没有其他取消在进行
+            auto& recv = conn->recvState();
+            if (!migratable || !conn->isRead() || !conn->isInflight(IoOpKind::READ) || conn->isInflight(IoOpKind::WRITE)
+                || conn->writeBuffer().readableBytes() > 0 || recv.shrinkRequested || recv.migrateRequested)
+            {
+                return;
+            }
+            if (cpu > hottestCpu || (cpu == hottestCpu && bytes > hottestBytes))
+            {
+                hottest = conn;
+                hottestCpu = cpu;
+                hottestBytes = bytes;
+            }
+        });
+        if (!hottest || !this->mMigrateTarget_)    return;
+        auto* target = this->mMigrateTarget_(*this, hottestCpu);
+        if (!target || target == this)  return;
+        // 取消在途读，取消完成后在所属线程上迁出
+        hottest->setMigrateTarget(target);
+        hottest->recvState().migrateRequested = (this->mEventQueue_.submitCancel(hottest) == ErrorCode::Success);
+    }
+
+    void IoService::migrateOut(Connection* conn)
+    {
+        auto* target = conn->migrateTarget();
+        conn->recvState().migrateRequested = false;
+        conn->setMigrateTarget(nullptr);
+        conn->takeAwaiting(IoOpKind::READ);
+        conn->setOwner(nullptr);
+        this->mTimer_.remove(conn);
+        // 空闲chunk归还本线程的chunk池，目标线程从其本地池重新分配，避免跨节点的内存随连接迁走；
+        // 读缓冲区中尚未处理的数据保留
+        conn->readBuffer().shrink(0);
+        conn->writeBuffer().shrink(0);
+        // 协程帧属于本IoService的内存池，须在本线程销毁；读写缓冲区与处理状态随连接对象一并转移
+        this->releaseSlot(conn);
+        conn->setEventQueue(nullptr);
+        this->mMigratedOut_.fetch_add(1, std::memory_order_relaxed);
+        target->acceptMigrated(conn);
+    }
+
+    void IoService::acceptMigrated(Connection* conn)
+    {
+        this->mMigratedIn_.fetch_add(1, std::memory_order_relaxed);
+        this->postConnection(conn, true);
+    }
 }   // namespace blitz
@@ -0,0 +1,54 @@
+#include "metrics.h"
+#include "buffer.h"
+
+namespace blitz
+{
+    struct MetricDesc
+    {
+        const char* name;
+        const char* type;
+        const char* help;
+    };
+
+    // 与Metric枚举一一对应
+    constexpr static MetricDesc MetricDescs[MetricNum] = {
+        {"blitz_accepts_total", "counter", "Accepted connections; on IO loops, connections handed over by the acceptor."},
+        {"blitz_active_connections", "gauge", "Connections currently owned by the loop."},
+        {"blitz_bytes_in_total", "counter", "Bytes received from sockets."},
+        {"blitz_bytes_out_total", "counter", "Bytes sent to sockets."},
+        {"blitz_sqes_submitted_total", "counter", "Submission queue entries consumed by the kernel."},
+        {"blitz_uring_enters_total", "counter", "io_uring_enter calls for submitting or waiting."},
+        {"blitz_cqes_reaped_total", "counter", "Completion queue entries reaped."},
+        {"blitz_cqe_waits_total", "counter", "Blocking waits for completions; cqes_reaped / cqe_waits is CQEs per wait."},
+        {"blitz_submit_queue_full_total", "counter", "Submissions rejected because the submission queue was full."},
+        {"blitz_timer_fires_total", "counter", "Connection timeouts and timers fired."},
+    };
+
+    static void AppendHeader(std::string& out, const char* name, const char* type, const char* help)
+    {
+        out.append("# HELP ").append(name).append(" ").append(help).append("\n");
+        out.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+    }
+
+    std::string RenderPrometheus(std::span<const LoopMetrics> loops)
+    {
+        std::string out;
+        out.reserve(256 * MetricNum);
+        for (std::size_t i = 0; i < MetricNum; ++i)
+        {
+            const auto& desc = MetricDescs[i];
+            AppendHeader(out, desc.name, desc.type, desc.help);
+            for (const auto& loop : loops)
+            {
+                out.append(desc.name).append("{loop=\"").append(loop.label).append("\"} ")
+                   .append(std::to_string(loop.snapshot.values[i])).append("\n");
+            }
+        }
+        // chunk池为进程级统计，不区分事件循环
+        AppendHeader(out, "blitz_buffer_allocated_bytes", "gauge", "Bytes held by buffer chunks, in use or pooled.");
+        out.append("blitz_buffer_allocated_bytes ").append(std::to_string(ChainBuffer::totalAllocatedBytes())).append("\n");
+        AppendHeader(out, "blitz_buffer_pooled_bytes", "gauge", "Bytes held by idle chunks in the per-thread pools.");
+        out.append("blitz_buffer_pooled_bytes ").append(std::to_string(ChainBuffer::totalPooledBytes())).append("\n");
+        return out;
+    }
+}   // namespace blitz
@@ -0,0 +1,176 @@
+#include "metrics_endpoint.h"
+#include <string_view>
+
+#ifdef __linux__
+#include <unistd.h>
+#elif _WIN32
+
+#endif
+
+namespace blitz
+{
+    // 抓取端连接数上限，超出的连接接受后立即关闭
+    constexpr static std::size_t MaxSessionNum = 16;
+    constexpr static int ListenBacklog = 16;
+    // 每次收发的期限，到期未完成即关闭会话，空闲或过慢的抓取端不能长期占用会话
+    constexpr static std::chrono::milliseconds IoTimeout{5000};
+
+    MetricsEndpoint::MetricsEndpoint(EventQueue& eq, std::uint16_t port, RenderFn render)
+        : mEventQueue_{eq}, mAcceptor_{eq}, mRender_{std::move(render)}
+    {
+        this->mAcceptor_.setEvent(EventType::ENDPOINT);
+        this->mAcceptor_.listen(port, ListenBacklog);
+        if (this->mAcceptor_.doOnce() != ErrorCode::Success)
+        {
+            throw std::system_error(make_error_code(ErrorCode::InternalError));
+        }
+    }
+
+    MetricsEndpoint::~MetricsEndpoint()
+    {
+        // 事件循环已停止，在途操作不会再完成
+        for (auto& session : this->mSessions_)
+        {
+            if (Stage::CLOSE != session->stage)
+            {
+                ::close(session->socket());
+            }
+        }
+    }
+
+    void MetricsEndpoint::onEvent(Event* ev)
+    {
+        std::int32_t res = this->mEventQueue_.lastResult();
+        if (ev == &this->mAcceptor_)
+        {
+            this->onAccept(res);
+            return;
+        }
+        auto* session = static_cast<Session*>(ev);
+        switch (session->stage)
+        {
+        case Stage::READ:
+            this->onRead(session, res);
+            break;
+        case Stage::WRITE:
+            this->onWrite(session, res);
+            break;
+        case Stage::CLOSE:
+            this->destroySession(session);
+            break;
+        }
+    }
+
+    void MetricsEndpoint::onAccept(std::int32_t res)
+    {
+        this->mAcceptor_.doOnce();
+        if (res < 0)    return;
+        if (this->mSessions_.size() >= MaxSessionNum)
+        {
+            ::close(res);
+            return;
+        }
+        auto session = std::make_unique<Session>(res);
+        session->index = this->mSessions_.size();
+        auto* raw = session.get();
+        this->mSessions_.push_back(std::move(session));
+        if (this->mEventQueue_.submitRecv(raw, raw->request, IoTimeout) != ErrorCode::Success)
+        {
+            ::close(res);
+            this->destroySession(raw);
+        }
+    }
+
+    void MetricsEndpoint::onRead(Session* session, std::int32_t res)
+    {
+        // 出错、对端关闭或超时取消（-ECANCELED）
+        if (res <= 0)
+        {
+            this->closeSession(session);
+            return;
+        }
+        session->received += res;
+        std::string_view request{session->request.data(), session->received};
+        // 只处理请求头，请求体（GET不应有）不予理会；请求头超长时按已读部分应答
+        if (std::string_view::npos != request.find("\r\n\r\n") || session->received == session->request.size())
+        {
+            this->respond(session);
+            return;
+        }
+        auto rest = std::span<char>{session->request}.subspan(session->received);
+        if (this->mEventQueue_.submitRecv(session, rest, IoTimeout) != ErrorCode::Success)
+        {
+            this->closeSession(session);
+        }
+    }
+
+    void MetricsEndpoint::respond(Session* session)
+    {
+        std::string_view request{session->request.data(), session->received};
+        std::string body;
+        const char* status = "200 OK";
+        if (request.starts_with("GET "))
+        {
+            body = this->mRender_();
+        }
+        else
+        {
+            status = "405 Method Not Allowed";
+        }
+        auto& out = session->response;
+        out.reserve(body.size() + 128);
+        out.append("HTTP/1.1 ").append(status).append("\r\n");
+        out.append("Content-Type: text/plain; version=0.0.4\r\n");
+        out.append("Content-Length: ").append(std::to_string(body.size())).append("\r\n");
+        out.append("Connection: close\r\n\r\n");
+        out.append(body);
+        session->stage = Stage::WRITE;
+        if (this->mEventQueue_.submitSend(session, out, IoTimeout) != ErrorCode::Success)
+        {
+            this->closeSession(session);
+        }
+    }
+
+    void MetricsEndpoint::onWrite(Session* session, std::int32_t res)
+    {
+        // 出错、对端关闭或超时取消（-ECANCELED）
+        if (res <= 0)
+        {
+            this->closeSession(session);
+            return;
+        }
+        session->sent += res;
+        if (session->sent == session->response.size())
+        {
+            this->closeSession(session);
+            return;
+        }
+        auto rest = std::span<const char>{session->response}.subspan(session->sent);
+        if (this->mEventQueue_.submitSend(session, rest, IoTimeout) != ErrorCode::Success)
+        {
+            this->closeSession(session);
+        }
+    }
+
+    void MetricsEndpoint::closeSession(Session* session)
+    {
+        session->stage = Stage::CLOSE;
+        if (this->mEventQueue_.submitClose(session) != ErrorCode::Success)
+        {
+            ::close(session->socket());
+            this->destroySession(session);
+        }
+    }
+
+    void MetricsEndpoint::destroySession(Session* session)
+    {
+        // 与末尾交换后移除
+        auto index = session->index;
+        if (index + 1 != this->mSessions_.size())
+        {
+            std::swap(this->mSessions_[index], this->mSessions_.back());
+            this->mSessions_[index]->index = index;
+        }
+        this->mSessions_.pop_back();
+    }
+}   // namespace blitz
@@ -0,0 +1,120 @@
+#include "placement.h"
+#include <algorithm>
+
+namespace blitz
+{
+    bool ShouldMigrate(std::uint64_t srcBusyNs, std::uint64_t dstBusyNs, std::uint64_t connCpuNs, double imbalanceRatio) noexcept
+    {
+        if (srcBusyNs <= dstBusyNs) return false;
+        if (static_cast<double>(srcBusyNs) <= imbalanceRatio * static_cast<double>(dstBusyNs))  return false;
+        return connCpuNs < (srcBusyNs - dstBusyNs) / 2;
+    }
+
+    PlacementPicker::PlacementPicker(PlacementPolicy policy)
+        : mPolicy_{policy}, mNextIdx_{0}, mRandState_{0x9E3779B97F4A7C15ull}, mLastSample_{}
+    {
+
+    }
+
+    std::size_t PlacementPicker::pick(std::span<const IoServiceLoad> loads, std::chrono::steady_clock::time_point now)
+    {
+        if (loads.size() <= 1)  return 0;
+        switch (this->mPolicy_)
+        {
+        case PlacementPolicy::LEAST_CONNECTIONS:
+            return this->pickLeastConnections(loads);
+        case PlacementPolicy::LEAST_CPU:
+            return this->pickLeastCpu(loads, now);
+        case PlacementPolicy::POWER_OF_TWO_CHOICES:
+            return this->pickPowerOfTwo(loads);
+        default:
+            return this->mNextIdx_++ % loads.size();
+        }
+    }
+
+    std::size_t PlacementPicker::pickLeastConnections(std::span<const IoServiceLoad> loads)
+    {
+        // 从轮转的起点开始扫描，并列时依次落到不同的IoService，突发的连接不会全部涌向下标0
+        std::size_t start = this->mNextIdx_++ % loads.size();
+        std::size_t best = start;
+        for (std::size_t k = 1; k < loads.size(); ++k)
+        {
+            std::size_t i = (start + k) % loads.size();
+            if (loads[i].activeConnections < loads[best].activeConnections)
+            {
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    std::size_t PlacementPicker::pickLeastCpu(std::span<const IoServiceLoad> loads, std::chrono::steady_clock::time_point now)
+    {
+        if (this->mBusySnapshot_.size() != loads.size())
+        {
+            this->mBusySnapshot_.assign(loads.size(), 0);
+            this->mRecentBusy_.assign(loads.size(), 0);
+            this->mPlacedInWindow_.assign(loads.size(), 0);
+            for (std::size_t i = 0; i < loads.size(); ++i)
+            {
+                this->mBusySnapshot_[i] = loads[i].busyNs;
+            }
+            this->mLastSample_ = now;
+        }
+        if (now - this->mLastSample_ >= CpuSampleWindow)
+        {
+            // 每个窗口采样一次各IoService的耗时增量
+            for (std::size_t i = 0; i < loads.size(); ++i)
+            {
+                this->mRecentBusy_[i] = loads[i].busyNs - this->mBusySnapshot_[i];
+                this->mBusySnapshot_[i] = loads[i].busyNs;
+                this->mPlacedInWindow_[i] = 0;
+            }
+            this->mLastSample_ = now;
+        }
+        // 新分配的连接尚未产生耗时：按上一窗口每连接的平均耗时预估计入，避免同一窗口内的连接全部涌向同一个IoService
+        std::uint64_t totalBusy = 0;
+        std::size_t totalConns = 0;
+        for (std::size_t i = 0; i < loads.size(); ++i)
+        {
+            totalBusy += this->mRecentBusy_[i];
+            totalConns += loads[i].activeConnections;
+        }
+        std::uint64_t perConn = totalBusy / std::max<std::size_t>(totalConns, 1);
+        auto cost = [&](std::size_t i)->std::uint64_t
+        {
+            return this->mRecentBusy_[i] + (loads[i].busyNs - this->mBusySnapshot_[i]) + this->mPlacedInWindow_[i] * perConn;
+        };
+        // 耗时相同时按连接数区分，仍并列时按轮转起点依次分配
+        std::size_t start = this->mNextIdx_++ % loads.size();
+        std::size_t best = start;
+        for (std::size_t k = 1; k < loads.size(); ++k)
+        {
+            std::size_t i = (start + k) % loads.size();
+            auto ci = cost(i), cb = cost(best);
+            if (ci < cb || (ci == cb && loads[i].activeConnections < loads[best].activeConnections))
+            {
+                best = i;
+            }
+        }
+        ++this->mPlacedInWindow_[best];
+        return best;
+    }
+
+    std::size_t PlacementPicker::pickPowerOfTwo(std::span<const IoServiceLoad> loads)
+    {
+        std::size_t a = this->nextRandom() % loads.size();
+        std::size_t b = this->nextRandom() % (loads.size() - 1);
+        if (b >= a) ++b;
+        return (loads[b].activeConnections < loads[a].activeConnections) ? b : a;
+    }
+
+    std::uint64_t PlacementPicker::nextRandom() noexcept
+    {
+        // xorshift64*
+        this->mRandState_ ^= this->mRandState_ >> 12;
+        this->mRandState_ ^= this->mRandState_ << 25;
+        this->mRandState_ ^= this->mRandState_ >> 27;
+        return this->mRandState_ * 0x2545F4914F6CDD1Dull;
+    }
+}   // namespace blitz
@@ -1,25 +1,45 @@
 #include "server.h"
 #include <iostream>
 #include "connection.h"
+#include "io_service.h"
 
 namespace blitz
 {
     TcpServer::TcpServer(std::size_t threadNum, std::uint16_t port, int backlog)
         : mMainEventQueue_{}, mAcceptor_{mMainEventQueue_}
-        , mPool_{std::make_unique<IoServicePool>(threadNum)}, isStopLoop_{false}
+        , mPool_{std::make_unique<IoServicePool>(threadNum)}, mMainCpu_{-1}, isStopLoop_{false}
     {
         this->mAcceptor_.listen(port, backlog);
         this->mAcceptor_.doOnce();
     }
 
-    void TcpServer::run(std::chrono::milliseconds tickMs)
+    void TcpServer::setMainThreadCpu(int cpu) noexcept
+    {
+        this->mMainCpu_ = cpu;
+        this->mPool_->reserveCpu(cpu);
+    }
+
+    std::error_code TcpServer::run(std::chrono::milliseconds tickMs)
     {
         std::error_code ec;
-        this->mPool_->start(this->mTimer_);
-        this->startTimer(tickMs);
+        if (this->mMainCpu_ >= 0)
+        {
+            const int cpus[] = {this->mMainCpu_};
+            PinCurrentThread(cpus);
+        }
+        using namespace std::chrono_literals;
+        if (tickMs > 0ms)
+        {
+            this->mPool_->setTimerResolution(tickMs);
+        }
+        if (ec = this->mPool_->start(); ec != ErrorCode::Success)
+        {
+            return ec;
+        }
         while (!this->isStopLoop_)
         {
             Event* ev = this->mMainEventQueue_.waitCompletionEvent(ec);
+            this->mStages_.applyPendingReset();
             if (!ev)    continue;
             if (ec != ErrorCode::Success)
             {
@@ -28,15 +48,16 @@ namespace blitz
             if (ev->isAccept())
             {
                 Connection* conn = static_cast<Connection*>(ev);
+                // 交给IO线程后不可再访问conn，起点另行保存
+                std::uint64_t acceptedAt = this->mStages_.sample(Stage::ACCEPT) ? StageHistograms::Now() : 0;
+                conn->stageStamps().accepted = acceptedAt;
                 this->mPool_->putNewConnection(conn);
-                this->mTimer_.add(conn);
+                this->mStages_.recordSince(Stage::ACCEPT, acceptedAt);
                 this->mAcceptor_.doOnce();
             }
-            else if (ev->isTick())
+            else if (ev->isEndpoint() && this->mMetricsEndpoint_)
             {
-                this->mTimer_.tick();
-                TickEvent::instance().setTimer(tickMs.count());
-                this->mMainEventQueue_.submitTimerTick();
+                this->mMetricsEndpoint_->onEvent(ev);
             }
             else if (ev->isSignal())
             {
@@ -46,6 +67,54 @@ namespace blitz
             }
         }
         std::cout << "run break" << std::endl;
+        return make_error_code(ErrorCode::Success);
+    }
+
+    MetricsSnapshot TcpServer::metrics() const noexcept
+    {
+        MetricsSnapshot total;
+        this->mMainEventQueue_.metrics().collect(total);
+        auto accepts = total[Metric::ACCEPTS];
+        total += this->mPool_->metrics();
+        // IO线程计入的是主线程接受后交给它的同一批连接，不重复累加
+        total[Metric::ACCEPTS] = accepts;
+        return total;
+    }
+
+    void TcpServer::setStageSampling(std::uint32_t every) noexcept
+    {
+        this->mStages_.setSampling(every);
+        this->mPool_->setStageSampling(every);
+    }
+
+    StageHistograms::Snapshot TcpServer::stageLatency() const noexcept
+    {
+        auto total = this->mStages_.snapshot();
+        total += this->mPool_->stageLatency();
+        return total;
+    }
+
+    void TcpServer::resetStageLatency() noexcept
+    {
+        this->mStages_.reset();
+        this->mPool_->resetStageLatency();
+    }
+
+    void TcpServer::enableMetricsEndpoint(std::uint16_t port)
+    {
+        this->mMetricsEndpoint_ = std::make_unique<MetricsEndpoint>(this->mMainEventQueue_, port, [this]()->std::string
+        {
+            // 抓取时才逐个读取各事件循环的计数
+            std::vector<LoopMetrics> loops;
+            loops.reserve(this->mPool_->size() + 1);
+            loops.push_back({"main", {}});
+            this->mMainEventQueue_.metrics().collect(loops.back().snapshot);
+            for (std::size_t i = 0; i < this->mPool_->size(); ++i)
+            {
+                loops.push_back({std::to_string(i), this->mPool_->ioService(i).metrics()});
+            }
+            return RenderPrometheus(loops);
+        });
     }
 
     void TcpServer::stop() 
@@ -54,17 +123,12 @@ namespace blitz
         this->mPool_.release();
     }
 
-    void TcpServer::startTimer(std::chrono::milliseconds tickMs)
-    {
-        using namespace std::chrono_literals;
-        if (0ms == tickMs)  return;
-        TickEvent::instance().setTimer(tickMs.count());
-        this->mMainEventQueue_.submitTimerTick();
-    }
-
     void TcpServer::setReadCallback(IoEventCallback cb) noexcept { this->mPool_->setReadCallback(cb); }
     void TcpServer::setWriteCallback(IoEventCallback cb) noexcept { this->mPool_->setWriteCallback(cb); }
     void TcpServer::setErrorCallback(ErrorCallback cb) noexcept { this->mPool_->setErrorCallback(cb); }
+    void TcpServer::setConnectionHandler(ConnectionHandler handler) noexcept { this->mPool_->setConnectionHandler(handler); }
+    void TcpServer::setKeepAlive(bool on) noexcept { this->mPool_->setKeepAlive(on); }
+    void TcpServer::setWriteHighWater(std::size_t bytes, HighWaterCallback cb) noexcept { this->mPool_->setWriteHighWater(bytes, cb); }
 
     void TcpServer::setSignalCallback(int sig, SignalCallback cb) noexcept
     {
@@ -72,8 +136,18 @@ namespace blitz
         this->mMainEventQueue_.submitSysSignal(sig);
     }
 
+    void TcpServer::setBufferShrinkPolicy(std::chrono::milliseconds idleTime, std::size_t highWaterBytes) noexcept
+    {
+        this->mPool_->setBufferShrinkPolicy(idleTime, highWaterBytes);
+    }
+
+    void TcpServer::setHandlerOffload(std::size_t threadNum)
+    {
+        this->mPool_->setHandlerOffload(threadNum);
+    }
+
     void TcpServer::setTimeoutCallback(TimeoutCallback cb, std::chrono::milliseconds timeoutMs) noexcept
     {
-        this->mTimer_.registTimeoutCallback(cb, timeoutMs);
+        this->mPool_->setTimeoutCallback(cb, timeoutMs);
     }
 }   // namespace blitz
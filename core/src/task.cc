@@ -0,0 +1,50 @@
+#include "task.h"
+#include "io_service.h"
+
+namespace blitz
+{
+    namespace detail
+    {
+        EventQueue*& CurrentEventQueue() noexcept
+        {
+            thread_local EventQueue* sCurrentEventQueue = nullptr;
+            return sCurrentEventQueue;
+        }
+
+        IoService*& CurrentIoService() noexcept
+        {
+            thread_local IoService* sCurrentIoService = nullptr;
+            return sCurrentIoService;
+        }
+    }   // namespace detail
+
+    SleepAwaiter::~SleepAwaiter()
+    {
+        if (this->mService_)
+        {
+            this->mService_->cancel(this->mTimer_);
+        }
+    }
+
+    bool SleepAwaiter::await_ready() const noexcept
+    {
+        using namespace std::chrono_literals;
+        return this->mTimeoutMs_ <= 0ms;
+    }
+
+    bool SleepAwaiter::await_suspend(std::coroutine_handle<> handle) noexcept
+    {
+        auto* service = detail::CurrentIoService();
+        if (!service)   return false;
+        this->mTimer_ = service->runAfter(this->mTimeoutMs_, [this, handle]()->void
+        {
+            // 恢复后协程可能结束并销毁本对象，先置空，析构时不再取消
+            this->mService_ = nullptr;
+            handle.resume();
+        });
+        // 提交失败则不挂起，直接继续执行
+        if (!this->mTimer_.valid()) return false;
+        this->mService_ = service;
+        return true;
+    }
+}   // namespace blitz
@@ -1,10 +1,12 @@
 #include "threadpool.h"
+#include <algorithm>
+#include <latch>
 #include "io_service.h"
 
 namespace blitz
 {
     IoServicePool::IoServicePool(std::size_t threadNum)
-        : mNextIoServiceIdx_{0}, mIoServices_{threadNum}
+        : mLoads_(threadNum), mAffinity_{AffinityPolicy::NONE}, mIoServices_{threadNum}
     {
 
     }
@@ -19,20 +21,68 @@ namespace blitz
         {
             service.wakeupFromWait();
         }
+        // 先等IO线程退出，此后不会再有任务提交到计算线程池；
+        // 再停止计算线程池：正在执行的任务执行完毕并投递恢复（IoService仍存活），排队的任务被丢弃，其协程随IoService销毁
+        this->mThreads_.clear();
+        for (auto& service : this->mIoServices_)
+        {
+            service.setComputePool(nullptr);
+        }
+        this->mComputePool_.reset();
     }
 
-    void IoServicePool::start(Timer& t)
+    std::error_code IoServicePool::start()
     {
+        std::vector<std::vector<int>> plan(this->mIoServices_.size());
+        if (AffinityPolicy::NONE != this->mAffinity_)
+        {
+            plan = PlanAffinity(this->mAffinity_, this->mAffinityCpus_, this->mIoServices_.size(),
+                                this->mReservedCpus_, CpuTopology::Detect());
+        }
+        // 各IO线程完成绑核与ring重建后才返回，任一失败则停止全部线程
+        std::vector<std::error_code> results(this->mIoServices_.size());
+        std::latch ready{static_cast<std::ptrdiff_t>(this->mIoServices_.size())};
         for (std::size_t i = 0; i < this->mIoServices_.size(); ++i)
         {
-            this->mThreads_.emplace_back([this, i, &t](std::stop_token stoken)->void
+            this->mThreads_.emplace_back([this, i, cpus = std::move(plan[i]), &results, &ready](std::stop_token stoken)->void
             {
+                // 绑核成功后重建ring；绑核失败时沿用构造时的ring
+                std::error_code ec = make_error_code(ErrorCode::Success);
+                if (PinCurrentThread(cpus))
+                {
+                    ec = this->mIoServices_[i].rebindToCurrentThread();
+                }
+                results[i] = ec;
+                ready.count_down();
+                if (ec != ErrorCode::Success)   return;
                 while (!stoken.stop_requested())
                 {
-                    this->mIoServices_[i].runOnce(t);
+                    this->mIoServices_[i].runOnce();
                 }
             });
         }
+        ready.wait();
+        for (const auto& ec : results)
+        {
+            if (ec == ErrorCode::Success)   continue;
+            for (auto& t : this->mThreads_)
+            {
+                t.request_stop();
+            }
+            for (auto& service : this->mIoServices_)
+            {
+                service.wakeupFromWait();
+            }
+            this->mThreads_.clear();
+            return ec;
+        }
+        return make_error_code(ErrorCode::Success);
+    }
+
+    void IoServicePool::setAffinity(AffinityPolicy policy, std::vector<int> cpuList) noexcept
+    {
+        this->mAffinity_ = policy;
+        this->mAffinityCpus_ = std::move(cpuList);
     }
 
     void IoServicePool::putNewConnection(Connection* conn)
@@ -65,10 +115,200 @@ namespace blitz
         }
     }
 
+    void IoServicePool::setConnectionHandler(ConnectionHandler handler) noexcept
+    {
+        for (auto& service : this->mIoServices_)
+        {
+            service.setConnectionHandler(handler);
+        }
+    }
+
+    void IoServicePool::setKeepAlive(bool on) noexcept
+    {
+        for (auto& service : this->mIoServices_)
+        {
+            service.setKeepAlive(on);
+        }
+    }
+
+    void IoServicePool::setWriteHighWater(std::size_t bytes, HighWaterCallback cb) noexcept
+    {
+        for (auto& service : this->mIoServices_)
+        {
+            service.setWriteHighWater(bytes, cb);
+        }
+    }
+
+    void IoServicePool::setBufferShrinkPolicy(std::chrono::milliseconds idleTime, std::size_t highWaterBytes) noexcept
+    {
+        for (auto& service : this->mIoServices_)
+        {
+            service.setBufferShrinkPolicy(idleTime, highWaterBytes);
+        }
+    }
+
+    void IoServicePool::setTimeoutCallback(TimeoutCallback cb, std::chrono::milliseconds timeoutMs) noexcept
+    {
+        for (auto& service : this->mIoServices_)
+        {
+            service.setTimeoutCallback(cb, timeoutMs);
+        }
+    }
+
+    void IoServicePool::setTimerResolution(std::chrono::milliseconds resolution) noexcept
+    {
+        for (auto& service : this->mIoServices_)
+        {
+            service.setTimerResolution(resolution);
+        }
+    }
+
+    void IoServicePool::setIoTimeouts(std::chrono::milliseconds readMs, std::chrono::milliseconds writeMs) noexcept
+    {
+        for (auto& service : this->mIoServices_)
+        {
+            service.setIoTimeouts(readMs, writeMs);
+        }
+    }
+
+    LatencyHistogram::Snapshot IoServicePool::postLatency() const noexcept
+    {
+        LatencyHistogram::Snapshot total;
+        for (auto& service : this->mIoServices_)
+        {
+            total += service.postLatency();
+        }
+        return total;
+    }
+
+    MetricsSnapshot IoServicePool::metrics() const noexcept
+    {
+        MetricsSnapshot total;
+        for (auto& service : this->mIoServices_)
+        {
+            total += service.metrics();
+        }
+        return total;
+    }
+
+    void IoServicePool::setStageSampling(std::uint32_t every) noexcept
+    {
+        for (auto& service : this->mIoServices_)
+        {
+            service.setStageSampling(every);
+        }
+    }
+
+    StageHistograms::Snapshot IoServicePool::stageLatency() const noexcept
+    {
+        StageHistograms::Snapshot total;
+        for (auto& service : this->mIoServices_)
+        {
+            total += service.stageLatency();
+        }
+        return total;
+    }
+
+    void IoServicePool::resetStageLatency() noexcept
+    {
+        for (auto& service : this->mIoServices_)
+        {
+            service.resetStageLatency();
+        }
+    }
+
+    std::size_t IoServicePool::size() const noexcept
+    {
+        return this->mIoServices_.size();
+    }
+
+    IoService& IoServicePool::ioService(std::size_t index) noexcept
+    {
+        return this->mIoServices_[index];
+    }
+
+    FrameArenaStats IoServicePool::frameArenaStats() const noexcept
+    {
+        FrameArenaStats total{0, 0, 0, 0, 0};
+        for (auto& service : this->mIoServices_)
+        {
+            auto s = service.frameArenaStats();
+            total.allocCount += s.allocCount;
+            total.poolHits += s.poolHits;
+            total.oversizeCount += s.oversizeCount;
+            total.liveFrames += s.liveFrames;
+            total.maxFrameSize = std::max(total.maxFrameSize, s.maxFrameSize);
+        }
+        return total;
+    }
+
+    void IoServicePool::setHandlerOffload(std::size_t threadNum)
+    {
+        this->mComputePool_ = (0 == threadNum) ? nullptr : std::make_unique<ComputePool>(threadNum);
+        for (auto& service : this->mIoServices_)
+        {
+            service.setComputePool(this->mComputePool_.get());
+        }
+    }
+
+    ComputePoolStats IoServicePool::computePoolStats() const noexcept
+    {
+        if (!this->mComputePool_)   return {0, 0, 0, 0};
+        return this->mComputePool_->stats();
+    }
+
+    std::size_t IoServicePool::postedQueueDepth() const noexcept
+    {
+        std::size_t depth = 0;
+        for (auto& service : this->mIoServices_)
+        {
+            depth += service.postedQueueDepth();
+        }
+        return depth;
+    }
+
+    void IoServicePool::setMigrationPolicy(std::chrono::milliseconds interval, double imbalanceRatio)
+    {
+        auto pickTarget = [this, imbalanceRatio](IoService& self, std::uint64_t connCpuNs)->IoService*
+        {
+            // 只读取各IoService发布的原子计数，可在任意IoService线程上调用
+            IoService* coolest = nullptr;
+            for (auto& service : this->mIoServices_)
+            {
+                if (&service == &self)  continue;
+                if (!coolest || service.recentBusyNs() < coolest->recentBusyNs())
+                {
+                    coolest = &service;
+                }
+            }
+            if (!coolest)   return nullptr;
+            return ShouldMigrate(self.recentBusyNs(), coolest->recentBusyNs(), connCpuNs, imbalanceRatio) ? coolest : nullptr;
+        };
+        for (auto& service : this->mIoServices_)
+        {
+            service.setMigrationPolicy(interval, pickTarget);
+        }
+    }
+
+    std::uint64_t IoServicePool::migratedConnections() const noexcept
+    {
+        std::uint64_t total = 0;
+        for (auto& service : this->mIoServices_)
+        {
+            total += service.migratedOut();
+        }
+        return total;
+    }
+
     IoService& IoServicePool::nextIoService()
     {
-        auto& service = this->mIoServices_[this->mNextIoServiceIdx_ % this->mIoServices_.size()];
-        ++this->mNextIoServiceIdx_;
-        return service;
+        if (PlacementPolicy::ROUND_ROBIN != this->mPicker_.policy())
+        {
+            for (std::size_t i = 0; i < this->mIoServices_.size(); ++i)
+            {
+                this->mLoads_[i] = this->mIoServices_[i].load();
+            }
+        }
+        return this->mIoServices_[this->mPicker_.pick(this->mLoads_, std::chrono::steady_clock::now())];
     }
 }   // namespace blitz
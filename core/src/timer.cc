@@ -1,49 +1,94 @@
 #include "timer.h"
+#include "connection.h"
 
 namespace blitz
 {
-    void Timer::tick() noexcept
+    // 判断超时的基准：空闲取最近一次读写完成时刻，读/写取该方向最近一次完成时刻
+    static std::chrono::steady_clock::time_point TimeoutBase(const detail::ConnectionTimerNode* node)
     {
-        std::lock_guard l{this->mMutex_};
-        while (!this->mTimeHeap_.empty())
+        return (TimeoutKind::IDLE == node->kind) ? node->conn->lastActiveTime() : node->last;
+    }
+
+    void Timer::tick(std::chrono::steady_clock::time_point now) noexcept
+    {
+        this->mWheel_.advance(now, [this, now](detail::TimerNode* node)->void
+        {
+            this->onExpire(static_cast<detail::ConnectionTimerNode*>(node), now);
+        });
+    }
+
+    void Timer::onExpire(detail::ConnectionTimerNode* node, std::chrono::steady_clock::time_point now)
+    {
+        auto timeout = this->mTimeouts_[static_cast<std::size_t>(node->kind)];
+        auto* conn = node->conn;
+        // 已提交关闭的连接只等待关闭完成，不再计时
+        if (conn->isClosed())   return;
+        if (conn->isOffloaded())
+        {
+            // 读回调在计算线程执行期间不回调，顺延一个周期后再检查
+            node->last = now;
+            this->mWheel_.schedule(node, timeout, now);
+            return;
+        }
+        if (TimeoutKind::IDLE != node->kind)
         {
-            auto& info = *this->mTimeHeap_.begin();
-            if (!info.expired()) break;
-            if (auto* conn = info.connection(); conn)
+            auto op = (TimeoutKind::READ == node->kind) ? IoOpKind::READ : IoOpKind::WRITE;
+            if (!conn->isInflight(op))
             {
-                if (this->mCb_) this->mCb_(conn);
+                // 该方向没有在途操作，一个周期后再检查；下次提交时会记录新的起算时刻
+                this->mWheel_.schedule(node, timeout, now);
+                return;
             }
-            this->mTimeHeap_.erase(this->mTimeHeap_.begin());
+        }
+        if (auto due = TimeoutBase(node) + timeout; due > now)
+        {
+            // 期间有读写完成，按剩余时间重排
+            this->mWheel_.schedule(node, std::chrono::ceil<std::chrono::milliseconds>(due - now), now);
+            return;
+        }
+        conn->setExpiredTimeout(node->kind);
+        if (this->mCb_) this->mCb_(conn);
+        if (!conn->isClosed())
+        {
+            node->last = now;
+            this->mWheel_.schedule(node, timeout, now);
         }
     }
 
     void Timer::registTimeoutCallback(TimeoutCallback cb, std::chrono::milliseconds timeoutMs) noexcept 
     { 
         this->mCb_ = cb; 
-        this->mTimeoutMs_ = timeoutMs; 
+        this->mTimeouts_[static_cast<std::size_t>(TimeoutKind::IDLE)] = timeoutMs; 
     }
 
-    void Timer::add(Connection* conn) noexcept
+    void Timer::setIoTimeouts(std::chrono::milliseconds readMs, std::chrono::milliseconds writeMs) noexcept
     {
-        using namespace std::chrono_literals;
-        if (this->mTimeoutMs_ == 0ms)   return;
-        std::lock_guard l{this->mMutex_};
-        this->mTimeHeap_.emplace(TimerInfo{conn, this->mTimeoutMs_});
+        this->mTimeouts_[static_cast<std::size_t>(TimeoutKind::READ)] = readMs;
+        this->mTimeouts_[static_cast<std::size_t>(TimeoutKind::WRITE)] = writeMs;
     }
 
-    void Timer::remove(Connection* conn) noexcept
+    void Timer::add(Connection* conn, std::chrono::steady_clock::time_point now) noexcept
     {
-        std::lock_guard l{this->mMutex_};
-        for (auto it = this->mTimeHeap_.begin(); it != this->mTimeHeap_.end();)
+        using namespace std::chrono_literals;
+        for (std::size_t i = 0; i < std::size(this->mTimeouts_); ++i)
         {
-            if (it->connection() == conn)
-            {
-                it = this->mTimeHeap_.erase(it);
-            }
-            else
+            auto timeout = this->mTimeouts_[i];
+            if (timeout == 0ms) continue;
+            auto& node = conn->timeoutNode(static_cast<TimeoutKind>(i));
+            if (std::chrono::steady_clock::time_point{} == node.last)
             {
-                ++it;
+                node.last = now;
             }
+            auto remain = std::chrono::ceil<std::chrono::milliseconds>(TimeoutBase(&node) + timeout - now);
+            this->mWheel_.schedule(&node, std::max(remain, 1ms), now);
+        }
+    }
+
+    void Timer::remove(Connection* conn) noexcept
+    {
+        for (auto kind : {TimeoutKind::READ, TimeoutKind::WRITE, TimeoutKind::IDLE})
+        {
+            this->mWheel_.cancel(&conn->timeoutNode(kind));
         }
     }
 }   // namespace blitz
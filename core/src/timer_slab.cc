@@ -0,0 +1,42 @@
+#include "timer_slab.h"
+
+namespace blitz
+{
+    namespace detail
+    {
+        TimerEntry* TimerSlab::acquire()
+        {
+            TimerEntry* entry = nullptr;
+            if (static_cast<std::uint32_t>(-1) != this->mFreeHead_)
+            {
+                entry = &this->mEntries_[this->mFreeHead_];
+                this->mFreeHead_ = entry->nextFree;
+            }
+            else
+            {
+                entry = &this->mEntries_.emplace_back();
+                entry->slot = static_cast<std::uint32_t>(this->mEntries_.size() - 1);
+            }
+            ++this->mSize_;
+            return entry;
+        }
+
+        void TimerSlab::release(TimerEntry* entry) noexcept
+        {
+            entry->cb.reset();
+            entry->active = false;
+            entry->inflight = false;
+            ++entry->generation;
+            entry->nextFree = this->mFreeHead_;
+            this->mFreeHead_ = entry->slot;
+            --this->mSize_;
+        }
+
+        TimerEntry* TimerSlab::find(TimerId id) noexcept
+        {
+            if (id.slot >= this->mEntries_.size())  return nullptr;
+            auto* entry = &this->mEntries_[id.slot];
+            return (entry->generation == id.generation && entry->active) ? entry : nullptr;
+        }
+    }   // namespace detail
+}   // namespace blitz
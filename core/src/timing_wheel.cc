@@ -0,0 +1,99 @@
+#include "timing_wheel.h"
+#include <algorithm>
+
+namespace blitz
+{
+    TimingWheel::TimingWheel(std::chrono::steady_clock::time_point start) noexcept
+        : mStart_{start}, mNow_{0}, mSize_{0}
+    {
+        for (auto& level : this->mSlots_)
+        {
+            for (auto& head : level)
+            {
+                head.prev = head.next = &head;
+            }
+        }
+    }
+
+    void TimingWheel::schedule(detail::TimerNode* node, std::chrono::milliseconds delay, std::chrono::steady_clock::time_point now) noexcept
+    {
+        if (node->linked())
+        {
+            this->cancel(node);
+        }
+        // 以当前时间而非已处理刻度为基准，推进滞后时不会提前到期
+        std::uint64_t base = std::max(this->toTick(now), this->mNow_);
+        std::uint64_t delta = std::clamp<std::int64_t>(delay.count(), 1, MaxDelta);
+        node->expire = std::min(base + delta, this->mNow_ + MaxDelta);
+        this->place(node);
+        ++this->mSize_;
+    }
+
+    void TimingWheel::cancel(detail::TimerNode* node) noexcept
+    {
+        if (!node->linked())    return;
+        Unlink(node);
+        --this->mSize_;
+    }
+
+    std::uint64_t TimingWheel::toTick(std::chrono::steady_clock::time_point tp) const noexcept
+    {
+        if (tp <= this->mStart_)    return 0;
+        return std::chrono::duration_cast<std::chrono::milliseconds>(tp - this->mStart_).count();
+    }
+
+    void TimingWheel::place(detail::TimerNode* node) noexcept
+    {
+        // 按距下一待处理刻度的差值选层，槽位取到期刻度在该层的对应位；已过期的节点放到下一刻度
+        std::uint64_t expire = std::max(node->expire, this->mNow_ + 1);
+        std::uint64_t delta = expire - this->mNow_ - 1;
+        std::size_t level = 0;
+        while (level + 1 < LevelNum && delta >= (std::uint64_t{1} << (LevelBits * (level + 1))))
+        {
+            ++level;
+        }
+        PushBack(&this->mSlots_[level][(expire >> (LevelBits * level)) & SlotMask], node);
+    }
+
+    void TimingWheel::cascade(std::size_t level, std::uint64_t tick) noexcept
+    {
+        // 调用时mNow_为tick的前一刻度，重新分配后节点的剩余刻度均小于本层跨度
+        detail::TimerNode pending;
+        Splice(&this->mSlots_[level][(tick >> (LevelBits * level)) & SlotMask], &pending);
+        while (pending.next != &pending)
+        {
+            auto* node = pending.next;
+            Unlink(node);
+            this->place(node);
+        }
+    }
+
+    void TimingWheel::Unlink(detail::TimerNode* node) noexcept
+    {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        node->prev = node->next = nullptr;
+    }
+
+    void TimingWheel::PushBack(detail::TimerNode* head, detail::TimerNode* node) noexcept
+    {
+        node->prev = head->prev;
+        node->next = head;
+        head->prev->next = node;
+        head->prev = node;
+    }
+
+    void TimingWheel::Splice(detail::TimerNode* head, detail::TimerNode* to) noexcept
+    {
+        if (head->next == head)
+        {
+            to->prev = to->next = to;
+            return;
+        }
+        to->next = head->next;
+        to->prev = head->prev;
+        to->next->prev = to;
+        to->prev->next = to;
+        head->prev = head->next = head;
+    }
+}   // namespace blitz
@@ -7,7 +7,9 @@
 int main()
 {
     using namespace std::chrono_literals;
-    std::string data = "HTTP/1.0 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 5\r\n\r\nblitz";
+    std::string data = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 5\r\n\r\nblitz";
+    // 所有连接共享同一份响应数据，写入时不再逐连接拷贝
+    blitz::SharedBuffer response{std::span{data.data(), data.size()}};
     std::uint16_t port = 8888;
     std::size_t threadNum = 7;
     std::mutex mt;
@@ -24,36 +26,22 @@ int main()
         svr.stop(); 
     });
 
-    svr.setReadCallback([&data, &mt](blitz::Connection* conn)->void
+    svr.setReadCallback([&response](blitz::Connection* conn)->void
     {
-        char ch;
-        std::error_code ec;
-        int state = 0;
-        while (state != 4)
+        // 在读缓冲区内原地查找请求头结束符，不逐字节拷贝
+        std::size_t pos = conn->find("\r\n\r\n");
+        if (pos == blitz::ChainBuffer::npos)
         {
-            conn->read(std::span{&ch, 1}, ec);
-            if (ec == blitz::ErrorCode::PeerClosed)
-            {
-                return;
-            }
-            if ((ch == '\r') || (ch == '\n'))
-            {
-                ++state;
-            } 
-            else
-            {
-                state = 0;
-            }
+            return;
         }
-        conn->write(std::span{data.data(), data.size()}, ec);
+        std::size_t headerLen = pos + 4;
+        conn->consume(headerLen);
+        std::error_code ec;
+        conn->write(response, ec);
     });
 
-    svr.setWriteCallback([&mt](blitz::Connection* conn)->void
-    {
-        std::lock_guard l{mt};
-        std::cout << "write done" << std::endl;
-        conn->close();
-    });
+    // 长连接模式下写完后直接等待下一个请求，写回调无事可做；IoService总会调用写回调，故仍需注册
+    svr.setWriteCallback([](blitz::Connection* conn)->void {});
 
     svr.setErrorCallback([&mt](blitz::Connection* conn, std::error_code ec)->void
     {
@@ -67,6 +55,10 @@ int main()
         std::cout << "connection time out" << std::endl;
     }, 1000ms);
 
+    svr.setBufferShrinkPolicy(5000ms, 64 * 1024);
+    // 长连接：客户端复用连接连续发送请求，不再每个请求重新握手
+    svr.setKeepAlive(true);
+
     svr.run(100ms);
     return 0;
 }
@@ -0,0 +1,186 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "buffer.h"
+
+// 对比三种在ChainBuffer中查找请求头结束符的方式：
+// 1. benchmark中原先的逐字节readFromBuffer
+// 2. readableSegments视图上的逐字节扫描
+// 3. ChainBuffer::find（SIMD）
+// 每轮都先写入同一请求再查找并清空，单独给出仅写入+清空的基线开销
+// 计时前先校验find在chunk边界、chunk首尾字节、SIMD块尾等位置的结果与std::string::find一致，不一致时返回非0
+
+static std::string MakeRequest(std::size_t headerNum)
+{
+    std::string req = "GET /index.html HTTP/1.1\r\nHost: localhost:8888\r\n";
+    for (std::size_t i = 0; i < headerNum; ++i)
+    {
+        req += "X-Blitz-Header-" + std::to_string(i) + ": some header value with moderate length\r\n";
+    }
+    req += "\r\n";
+    return req;
+}
+
+template <typename Fn>
+static void Run(const char* name, const std::string& req, std::size_t rounds, Fn&& fn)
+{
+    blitz::ChainBuffer buf;
+    std::size_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < rounds; ++i)
+    {
+        buf.writeIntoBuffer(req);
+        checksum += fn(buf);
+        buf.consume(buf.readableBytes());
+    }
+    auto cost = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << "  " << name << ": " << cost.count() / rounds << " ns/op (checksum " << checksum << ")" << std::endl;
+}
+
+static std::size_t FillOnly(blitz::ChainBuffer& buf)
+{
+    return 0;
+}
+
+static std::size_t ByteWiseRead(blitz::ChainBuffer& buf)
+{
+    char ch;
+    int state = 0;
+    std::size_t n = 0;
+    while (state != 4)
+    {
+        if (0 == buf.readFromBuffer(std::span{&ch, 1}))   break;
+        ++n;
+        state = ((ch == '\r') || (ch == '\n')) ? state + 1 : 0;
+    }
+    return n;
+}
+
+static std::size_t ByteWiseView(blitz::ChainBuffer& buf)
+{
+    int state = 0;
+    std::size_t n = 0;
+    for (auto segment : buf.readableSegments())
+    {
+        for (char ch : segment)
+        {
+            ++n;
+            state = ((ch == '\r') || (ch == '\n')) ? state + 1 : 0;
+            if (state == 4) return n;
+        }
+    }
+    return n;
+}
+
+static std::size_t SimdFind(blitz::ChainBuffer& buf)
+{
+    return buf.find("\r\n\r\n") + 4;
+}
+
+static int sFailures = 0;
+
+// 读指针先前移skip字节，使chunk内数据起点不对齐
+static void CheckFind(const std::string& content, std::size_t skip, std::string_view delim, const char* what)
+{
+    blitz::ChainBuffer buf;
+    buf.writeIntoBuffer(std::string(skip, '-'));
+    buf.writeIntoBuffer(content);
+    buf.consume(skip);
+    std::size_t expected = content.find(delim);
+    std::size_t actual = buf.find(delim);
+    if (expected == std::string::npos)  expected = blitz::ChainBuffer::npos;
+    if (actual != expected)
+    {
+        ++sFailures;
+        std::cout << "FAIL " << what << ": skip " << skip << ", delimiter size " << delim.size()
+                  << ", expected " << expected << ", got " << actual << std::endl;
+    }
+}
+
+// 各chunk在可读区域中的起始偏移
+static std::vector<std::size_t> ChunkStarts(std::size_t skip, std::size_t size)
+{
+    blitz::ChainBuffer buf;
+    buf.writeIntoBuffer(std::string(skip + size, 'a'));
+    buf.consume(skip);
+    std::vector<std::size_t> starts;
+    std::size_t offset = 0;
+    for (auto segment : buf.readableSegments())
+    {
+        starts.push_back(offset);
+        offset += segment.size();
+    }
+    return starts;
+}
+
+static void CheckAt(std::size_t size, std::size_t skip, std::size_t pos, const char* what)
+{
+    for (std::string_view delim : {std::string_view{"\n"}, std::string_view{"\r\n\r\n"}})
+    {
+        if (pos + delim.size() > size)  continue;
+        std::string content(size, 'a');
+        content.replace(pos, delim.size(), delim);
+        CheckFind(content, skip, delim, what);
+    }
+}
+
+static void CheckCorrectness()
+{
+    constexpr std::size_t Size = 4000;
+    for (std::size_t skip : {0, 1, 7, 31})
+    {
+        auto starts = ChunkStarts(skip, Size);
+        if (starts.size() < 3)
+        {
+            ++sFailures;
+            std::cout << "FAIL test data spans only " << starts.size() << " chunk(s)" << std::endl;
+            return;
+        }
+        CheckAt(Size, skip, 0, "offset 0");
+        CheckAt(Size, skip, Size - 1, "last byte of buffer");
+        CheckAt(Size, skip, Size - 4, "buffer tail");
+        for (std::size_t i = 1; i < starts.size(); ++i)
+        {
+            std::size_t boundary = starts[i];
+            CheckAt(Size, skip, boundary - 1, "last byte of chunk");
+            CheckAt(Size, skip, boundary - 2, "across chunk boundary");
+            CheckAt(Size, skip, boundary - 3, "across chunk boundary");
+            CheckAt(Size, skip, boundary, "first byte of chunk");
+            // 落在16/32字节块尾与标量收尾部分
+            for (std::size_t back : {15, 16, 17, 31, 32, 33})
+            {
+                CheckAt(Size, skip, boundary - back, "SIMD block edge");
+            }
+        }
+        // 分隔符前缀恰好止于chunk末尾但随后不匹配，真正的分隔符在更后面
+        std::string content(Size, 'a');
+        content.replace(starts[1] - 3, 3, "\r\n\r");
+        content.replace(starts[2] + 5, 4, "\r\n\r\n");
+        CheckFind(content, skip, "\r\n\r\n", "partial match at chunk end");
+        CheckFind(std::string(Size, 'a'), skip, "\r\n\r\n", "not found");
+    }
+}
+
+int main()
+{
+    CheckCorrectness();
+    if (sFailures > 0)
+    {
+        std::cout << sFailures << " find check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "find checks passed" << std::endl;
+
+    constexpr std::size_t Rounds = 20000;
+    for (std::size_t headerNum : {2, 16, 64})
+    {
+        auto req = MakeRequest(headerNum);
+        std::cout << "request size " << req.size() << " bytes" << std::endl;
+        Run("fill only      ", req, Rounds, &FillOnly);
+        Run("byte-wise read ", req, Rounds, &ByteWiseRead);
+        Run("byte-wise view ", req, Rounds, &ByteWiseView);
+        Run("simd find      ", req, Rounds, &SimdFind);
+    }
+    return 0;
+}
@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <vector>
+#include "placement.h"
+
+// 偏斜负载下各分配策略的请求延迟对比（虚拟时间离散事件模拟，结果可复现）：
+// 连接平均存活0.5s、期间每10ms发送一个请求，10%的连接每个请求耗时是其余连接的20倍；
+// 每个IoService按FIFO串行处理，请求延迟 = 排队 + 处理；分配决策直接调用PlacementPicker
+// 另对轮转分配叠加连接迁移（每100ms由各IoService调用ShouldMigrate决定是否迁出最热连接）；
+// P2C与LEAST_CPU的p99不优于轮转、迁移未改善轮转的p99或出现来回迁移时返回非0
+
+namespace
+{
+    constexpr std::size_t WorkerNum = 8;
+    constexpr std::uint64_t SimulateNs = 20'000'000'000ull;        // 20s
+    constexpr double ArrivalPerSec = 1920.0;
+    constexpr double MeanLifetimeNs = 5e8;
+    constexpr std::uint64_t RequestIntervalNs = 10'000'000;        // 每连接10ms一个请求
+    constexpr std::uint64_t LightCostNs = 20'000;
+    constexpr std::uint64_t HeavyCostNs = 400'000;
+    constexpr double HeavyRatio = 0.1;
+    constexpr std::uint64_t MigrateIntervalNs = 100'000'000;       // 100ms
+    constexpr double ImbalanceRatio = 1.25;
+
+    enum class EvKind : std::uint8_t { ARRIVE, REQUEST, LEAVE, MIGRATE };
+
+    struct Ev
+    {
+        std::uint64_t t;
+        EvKind kind;
+        std::uint32_t conn;
+        bool operator>(const Ev& rhs) const { return this->t > rhs.t; }
+    };
+
+    struct Conn
+    {
+        std::size_t worker;
+        std::uint64_t cost;
+        std::uint64_t end;
+        std::uint64_t cpu;              // 本迁移周期内的耗时
+        std::size_t lastFrom;           // 上次迁出的IoService
+        std::uint64_t lastMigrated;     // 上次迁移的周期序号，0表示未迁移过
+    };
+
+    struct MigrationStats
+    {
+        std::size_t migrations{0};
+        std::size_t pingPongs{0};       // 相邻两个周期内迁出后又迁回原处
+    };
+
+    // 每个IoService用上一周期的耗时增量挑出本地最热的连接，按ShouldMigrate迁往最空闲的IoService
+    void Migrate(std::vector<Conn>& conns, std::vector<blitz::IoServiceLoad>& loads, std::vector<std::uint64_t>& busySnapshot,
+                 std::uint64_t now, std::uint64_t round, MigrationStats& stats)
+    {
+        std::vector<std::uint64_t> recent(WorkerNum);
+        for (std::size_t w = 0; w < WorkerNum; ++w)
+        {
+            recent[w] = loads[w].busyNs - busySnapshot[w];
+            busySnapshot[w] = loads[w].busyNs;
+        }
+        std::vector<std::int64_t> hottest(WorkerNum, -1);
+        for (std::size_t i = 0; i < conns.size(); ++i)
+        {
+            auto& c = conns[i];
+            if (c.end > now && (hottest[c.worker] < 0 || c.cpu > conns[hottest[c.worker]].cpu))
+            {
+                hottest[c.worker] = static_cast<std::int64_t>(i);
+            }
+        }
+        for (std::size_t w = 0; w < WorkerNum; ++w)
+        {
+            if (hottest[w] < 0)  continue;
+            std::size_t coolest = (0 == w) ? 1 : 0;
+            for (std::size_t t = 0; t < WorkerNum; ++t)
+            {
+                if (t != w && recent[t] < recent[coolest])  coolest = t;
+            }
+            auto& c = conns[hottest[w]];
+            if (!blitz::ShouldMigrate(recent[w], recent[coolest], c.cpu, ImbalanceRatio))  continue;
+            if (c.lastMigrated + 1 == round && c.lastFrom == coolest)   ++stats.pingPongs;
+            --loads[w].activeConnections;
+            ++loads[coolest].activeConnections;
+            recent[w] -= c.cpu;
+            recent[coolest] += c.cpu;
+            c.lastFrom = w;
+            c.lastMigrated = round;
+            c.worker = coolest;
+            ++stats.migrations;
+        }
+        for (auto& c : conns)
+        {
+            c.cpu = 0;
+        }
+    }
+
+    std::vector<std::uint64_t> Simulate(blitz::PlacementPolicy policy, MigrationStats* migration = nullptr)
+    {
+        std::mt19937_64 rng{42};
+        std::exponential_distribution<double> interArrival{ArrivalPerSec / 1e9};
+        std::exponential_distribution<double> lifetime{1.0 / MeanLifetimeNs};
+        std::bernoulli_distribution heavy{HeavyRatio};
+        std::uniform_int_distribution<std::uint64_t> phase{0, RequestIntervalNs - 1};
+
+        blitz::PlacementPicker picker{policy};
+        std::vector<blitz::IoServiceLoad> loads(WorkerNum, blitz::IoServiceLoad{0, 0});
+        std::vector<std::uint64_t> busyUntil(WorkerNum, 0);
+        std::vector<Conn> conns;
+        std::vector<std::uint64_t> latencies;
+        std::priority_queue<Ev, std::vector<Ev>, std::greater<Ev>> evs;
+        evs.push({static_cast<std::uint64_t>(interArrival(rng)), EvKind::ARRIVE, 0});
+        std::vector<std::uint64_t> busySnapshot(WorkerNum, 0);
+        std::uint64_t round = 0;
+        if (migration)
+        {
+            evs.push({MigrateIntervalNs, EvKind::MIGRATE, 0});
+        }
+
+        while (!evs.empty())
+        {
+            Ev ev = evs.top();
+            evs.pop();
+            if (ev.t >= SimulateNs) break;
+            switch (ev.kind)
+            {
+            case EvKind::ARRIVE:
+            {
+                auto now = std::chrono::steady_clock::time_point{std::chrono::nanoseconds{ev.t}};
+                std::size_t w = picker.pick(loads, now);
+                ++loads[w].activeConnections;
+                auto id = static_cast<std::uint32_t>(conns.size());
+                conns.push_back({w, heavy(rng) ? HeavyCostNs : LightCostNs, ev.t + static_cast<std::uint64_t>(lifetime(rng)), 0, 0, 0});
+                evs.push({ev.t + phase(rng), EvKind::REQUEST, id});
+                evs.push({conns[id].end, EvKind::LEAVE, id});
+                evs.push({ev.t + static_cast<std::uint64_t>(interArrival(rng)), EvKind::ARRIVE, 0});
+                break;
+            }
+            case EvKind::REQUEST:
+            {
+                auto& c = conns[ev.conn];
+                if (ev.t >= c.end)  break;
+                std::uint64_t start = std::max(ev.t, busyUntil[c.worker]);
+                busyUntil[c.worker] = start + c.cost;
+                loads[c.worker].busyNs += c.cost;
+                c.cpu += c.cost;
+                latencies.push_back(busyUntil[c.worker] - ev.t);
+                evs.push({ev.t + RequestIntervalNs, EvKind::REQUEST, ev.conn});
+                break;
+            }
+            case EvKind::LEAVE:
+                --loads[conns[ev.conn].worker].activeConnections;
+                break;
+            case EvKind::MIGRATE:
+                Migrate(conns, loads, busySnapshot, ev.t, ++round, *migration);
+                evs.push({ev.t + MigrateIntervalNs, EvKind::MIGRATE, 0});
+                break;
+            }
+        }
+        return latencies;
+    }
+
+    // 返回p99（微秒）
+    double Report(const char* name, blitz::PlacementPolicy policy, MigrationStats* migration = nullptr)
+    {
+        auto lat = Simulate(policy, migration);
+        std::sort(lat.begin(), lat.end());
+        auto pct = [&lat](double p)->double { return lat[static_cast<std::size_t>(p * (lat.size() - 1))] / 1000.0; };
+        std::cout << std::left << std::setw(24) << name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << pct(0.50) << std::setw(12) << pct(0.99) << std::setw(12) << pct(0.999)
+                  << std::setw(12) << lat.size() << std::endl;
+        return pct(0.99);
+    }
+}
+
+int main()
+{
+    std::cout << std::left << std::setw(24) << "policy" << std::right << std::setw(10) << "p50(us)"
+              << std::setw(12) << "p99(us)" << std::setw(12) << "p999(us)" << std::setw(12) << "requests" << std::endl;
+    double roundRobin = Report("round-robin", blitz::PlacementPolicy::ROUND_ROBIN);
+    Report("least-connections", blitz::PlacementPolicy::LEAST_CONNECTIONS);
+    double leastCpu = Report("least-cpu", blitz::PlacementPolicy::LEAST_CPU);
+    double powerOfTwo = Report("power-of-two-choices", blitz::PlacementPolicy::POWER_OF_TWO_CHOICES);
+    MigrationStats stats;
+    double migrated = Report("round-robin + migration", blitz::PlacementPolicy::ROUND_ROBIN, &stats);
+    std::cout << "migrations " << stats.migrations << ", ping-pongs " << stats.pingPongs << std::endl;
+    int failures = 0;
+    if (0 == stats.migrations || migrated >= roundRobin)
+    {
+        std::cout << "FAIL migration does not improve round-robin p99" << std::endl;
+        ++failures;
+    }
+    if (stats.pingPongs > 0)
+    {
+        std::cout << "FAIL connections migrated back and forth" << std::endl;
+        ++failures;
+    }
+    if (leastCpu >= roundRobin)
+    {
+        std::cout << "FAIL least-cpu p99 is not better than round-robin" << std::endl;
+        ++failures;
+    }
+    if (powerOfTwo >= roundRobin)
+    {
+        std::cout << "FAIL power-of-two-choices p99 is not better than round-robin" << std::endl;
+        ++failures;
+    }
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,113 @@
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+#include <vector>
+#include "timing_wheel.h"
+
+// 100万个定时器：时间轮与原std::set实现的插入、取消、到期处理耗时对比。
+// 原实现按连接取消时需线性扫描整个集合，仅抽样测量后按总数折算
+
+namespace
+{
+    constexpr std::size_t TimerNum = 1'000'000;
+    constexpr std::size_t SetRemoveSamples = 200;
+    constexpr std::int64_t MaxDelayMs = 60'000;
+
+    using Clock = std::chrono::steady_clock;
+
+    struct SetEntry
+    {
+        Clock::time_point time;
+        std::size_t id;
+        bool operator<(const SetEntry& rhs) const { return time < rhs.time || (time == rhs.time && id < rhs.id); }
+    };
+
+    double NsPerOp(Clock::duration d, std::size_t n)
+    {
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count()) / n;
+    }
+
+    void Report(const char* name, double ns)
+    {
+        std::cout << std::left << std::setw(28) << name << std::right << std::setw(14) << std::fixed << std::setprecision(1) << ns << " ns/op" << std::endl;
+    }
+}
+
+int main()
+{
+    std::mt19937_64 rng{42};
+    std::uniform_int_distribution<std::int64_t> delayDist{1, MaxDelayMs};
+    std::vector<std::chrono::milliseconds> delays(TimerNum);
+    for (auto& d : delays)
+    {
+        d = std::chrono::milliseconds{delayDist(rng)};
+    }
+
+    // 时间轮
+    auto start = Clock::now();
+    blitz::TimingWheel wheel{start};
+    std::vector<blitz::detail::TimerNode> nodes(TimerNum);
+    auto t0 = Clock::now();
+    for (std::size_t i = 0; i < TimerNum; ++i)
+    {
+        wheel.schedule(&nodes[i], delays[i]);
+    }
+    auto t1 = Clock::now();
+    for (std::size_t i = 0; i < TimerNum; i += 2)
+    {
+        wheel.cancel(&nodes[i]);
+    }
+    auto t2 = Clock::now();
+    std::size_t fired = 0, late = 0;
+    std::uint64_t lastTick = 0;
+    wheel.advance(start + std::chrono::milliseconds{MaxDelayMs + 1000}, [&](blitz::detail::TimerNode* node)->void
+    {
+        // 到期顺序须单调不减
+        late += (node->expire < lastTick);
+        lastTick = node->expire;
+        ++fired;
+    });
+    auto t3 = Clock::now();
+    std::cout << "timers: " << TimerNum << ", cancelled: " << TimerNum / 2 << ", fired: " << fired
+              << ", out of order: " << late << ", left: " << wheel.size() << std::endl;
+    Report("wheel schedule", NsPerOp(t1 - t0, TimerNum));
+    Report("wheel cancel", NsPerOp(t2 - t1, TimerNum / 2));
+    Report("wheel expire", NsPerOp(t3 - t2, fired));
+
+    // 原实现：std::set按到期时间排序，按连接取消需线性扫描
+    std::set<SetEntry> timers;
+    t0 = Clock::now();
+    for (std::size_t i = 0; i < TimerNum; ++i)
+    {
+        timers.insert({start + delays[i], i});
+    }
+    t1 = Clock::now();
+    for (std::size_t k = 0; k < SetRemoveSamples; ++k)
+    {
+        std::size_t id = (k * 7919) % TimerNum;
+        for (auto it = timers.begin(); it != timers.end(); ++it)
+        {
+            if (it->id == id)
+            {
+                timers.erase(it);
+                break;
+            }
+        }
+    }
+    t2 = Clock::now();
+    fired = 0;
+    auto deadline = start + std::chrono::milliseconds{MaxDelayMs + 1000};
+    while (!timers.empty() && timers.begin()->time <= deadline)
+    {
+        timers.erase(timers.begin());
+        ++fired;
+    }
+    t3 = Clock::now();
+    Report("std::set insert", NsPerOp(t1 - t0, TimerNum));
+    Report("std::set remove (scan)", NsPerOp(t2 - t1, SetRemoveSamples));
+    Report("std::set expire", NsPerOp(t3 - t2, fired));
+    return 0;
+}